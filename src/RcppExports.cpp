@@ -10,9 +10,55 @@ Rcpp::Rostream<true>&  Rcpp::Rcout = Rcpp::Rcpp_cout_get();
 Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
+// price_geometric_asian_american_cpp
+Rcpp::List price_geometric_asian_american_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, Rcpp::IntegerVector exercise, std::string option_type, double memory_budget, std::string scratch_dir);
+RcppExport SEXP _AsianOptPI_price_geometric_asian_american_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP exerciseSEXP, SEXP option_typeSEXP, SEXP memory_budgetSEXP, SEXP scratch_dirSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type K(KSEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type exercise(exerciseSEXP);
+    Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
+    Rcpp::traits::input_parameter< double >::type memory_budget(memory_budgetSEXP);
+    Rcpp::traits::input_parameter< std::string >::type scratch_dir(scratch_dirSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_geometric_asian_american_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, exercise, option_type, memory_budget, scratch_dir));
+    return rcpp_result_gen;
+END_RCPP
+}
+// price_arithmetic_asian_cpp
+double price_arithmetic_asian_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, std::string option_type, int n_fixed, double fixed_sum, double fixed_log_sum);
+RcppExport SEXP _AsianOptPI_price_arithmetic_asian_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP option_typeSEXP, SEXP n_fixedSEXP, SEXP fixed_sumSEXP, SEXP fixed_log_sumSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type K(KSEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_sum(fixed_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_log_sum(fixed_log_sumSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_arithmetic_asian_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, option_type, n_fixed, fixed_sum, fixed_log_sum));
+    return rcpp_result_gen;
+END_RCPP
+}
 // arithmetic_asian_bounds_cpp
-Rcpp::List arithmetic_asian_bounds_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, std::string option_type);
-RcppExport SEXP _AsianOptPI_arithmetic_asian_bounds_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP option_typeSEXP) {
+Rcpp::List arithmetic_asian_bounds_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, std::string option_type, int n_fixed, double fixed_sum, double fixed_log_sum, double fixed_min, double fixed_max);
+RcppExport SEXP _AsianOptPI_arithmetic_asian_bounds_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP option_typeSEXP, SEXP n_fixedSEXP, SEXP fixed_sumSEXP, SEXP fixed_log_sumSEXP, SEXP fixed_minSEXP, SEXP fixed_maxSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -26,13 +72,18 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
     Rcpp::traits::input_parameter< int >::type n(nSEXP);
     Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
-    rcpp_result_gen = Rcpp::wrap(arithmetic_asian_bounds_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, option_type));
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_sum(fixed_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_log_sum(fixed_log_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_min(fixed_minSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_max(fixed_maxSEXP);
+    rcpp_result_gen = Rcpp::wrap(arithmetic_asian_bounds_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, option_type, n_fixed, fixed_sum, fixed_log_sum, fixed_min, fixed_max));
     return rcpp_result_gen;
 END_RCPP
 }
 // arithmetic_asian_bounds_extended_cpp
-Rcpp::List arithmetic_asian_bounds_extended_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, bool compute_path_specific, int max_sample_size, double sample_fraction, std::string option_type);
-RcppExport SEXP _AsianOptPI_arithmetic_asian_bounds_extended_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP compute_path_specificSEXP, SEXP max_sample_sizeSEXP, SEXP sample_fractionSEXP, SEXP option_typeSEXP) {
+Rcpp::List arithmetic_asian_bounds_extended_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, bool compute_path_specific, int max_sample_size, double sample_fraction, std::string option_type, int n_fixed, double fixed_sum, double fixed_log_sum, double fixed_min, double fixed_max);
+RcppExport SEXP _AsianOptPI_arithmetic_asian_bounds_extended_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP compute_path_specificSEXP, SEXP max_sample_sizeSEXP, SEXP sample_fractionSEXP, SEXP option_typeSEXP, SEXP n_fixedSEXP, SEXP fixed_sumSEXP, SEXP fixed_log_sumSEXP, SEXP fixed_minSEXP, SEXP fixed_maxSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -49,7 +100,64 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< int >::type max_sample_size(max_sample_sizeSEXP);
     Rcpp::traits::input_parameter< double >::type sample_fraction(sample_fractionSEXP);
     Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
-    rcpp_result_gen = Rcpp::wrap(arithmetic_asian_bounds_extended_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, compute_path_specific, max_sample_size, sample_fraction, option_type));
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_sum(fixed_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_log_sum(fixed_log_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_min(fixed_minSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_max(fixed_maxSEXP);
+    rcpp_result_gen = Rcpp::wrap(arithmetic_asian_bounds_extended_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, compute_path_specific, max_sample_size, sample_fraction, option_type, n_fixed, fixed_sum, fixed_log_sum, fixed_min, fixed_max));
+    return rcpp_result_gen;
+END_RCPP
+}
+// price_bid_ask_cpp
+Rcpp::List price_bid_ask_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, std::string option_type, std::string average, std::string method, int n_simulations, int seed, int n_fixed, double fixed_sum, double fixed_log_sum);
+RcppExport SEXP _AsianOptPI_price_bid_ask_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP option_typeSEXP, SEXP averageSEXP, SEXP methodSEXP, SEXP n_simulationsSEXP, SEXP seedSEXP, SEXP n_fixedSEXP, SEXP fixed_sumSEXP, SEXP fixed_log_sumSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type K(KSEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type average(averageSEXP);
+    Rcpp::traits::input_parameter< std::string >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< int >::type n_simulations(n_simulationsSEXP);
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_sum(fixed_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_log_sum(fixed_log_sumSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_bid_ask_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, option_type, average, method, n_simulations, seed, n_fixed, fixed_sum, fixed_log_sum));
+    return rcpp_result_gen;
+END_RCPP
+}
+// price_book_impact_cpp
+Rcpp::List price_book_impact_cpp(double S0, Rcpp::NumericVector K, Rcpp::IntegerVector n, std::vector<std::string> option_type, Rcpp::NumericVector notional, double r, double u, double d, double lambda, double v_u, double v_d, double damping, double tol, int max_iter, int n_threads);
+RcppExport SEXP _AsianOptPI_price_book_impact_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP nSEXP, SEXP option_typeSEXP, SEXP notionalSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP dampingSEXP, SEXP tolSEXP, SEXP max_iterSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type K(KSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type n(nSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type option_type(option_typeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type notional(notionalSEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< double >::type damping(dampingSEXP);
+    Rcpp::traits::input_parameter< double >::type tol(tolSEXP);
+    Rcpp::traits::input_parameter< int >::type max_iter(max_iterSEXP);
+    Rcpp::traits::input_parameter< int >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_book_impact_cpp(S0, K, n, option_type, notional, r, u, d, lambda, v_u, v_d, damping, tol, max_iter, n_threads));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -91,9 +199,29 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// price_european_batch_cpp
+Rcpp::NumericVector price_european_batch_cpp(Rcpp::NumericVector S0, Rcpp::NumericVector K, Rcpp::NumericVector r, Rcpp::NumericVector u, Rcpp::NumericVector d, Rcpp::NumericVector lambda, Rcpp::NumericVector v_u, Rcpp::NumericVector v_d, Rcpp::IntegerVector n, std::vector<std::string> option_type);
+RcppExport SEXP _AsianOptPI_price_european_batch_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP option_typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type K(KSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type r(rSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type u(uSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type d(dSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type n(nSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type option_type(option_typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_european_batch_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, option_type));
+    return rcpp_result_gen;
+END_RCPP
+}
 // price_geometric_asian_cpp
-double price_geometric_asian_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, std::string option_type);
-RcppExport SEXP _AsianOptPI_price_geometric_asian_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP option_typeSEXP) {
+double price_geometric_asian_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, std::string option_type, int n_fixed, double fixed_sum, double fixed_log_sum);
+RcppExport SEXP _AsianOptPI_price_geometric_asian_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP option_typeSEXP, SEXP n_fixedSEXP, SEXP fixed_sumSEXP, SEXP fixed_log_sumSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -107,13 +235,16 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
     Rcpp::traits::input_parameter< int >::type n(nSEXP);
     Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
-    rcpp_result_gen = Rcpp::wrap(price_geometric_asian_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, option_type));
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_sum(fixed_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_log_sum(fixed_log_sumSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_geometric_asian_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, option_type, n_fixed, fixed_sum, fixed_log_sum));
     return rcpp_result_gen;
 END_RCPP
 }
 // price_geometric_asian_mc_cpp
-Rcpp::List price_geometric_asian_mc_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, int n_simulations, std::string option_type, int seed);
-RcppExport SEXP _AsianOptPI_price_geometric_asian_mc_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP n_simulationsSEXP, SEXP option_typeSEXP, SEXP seedSEXP) {
+Rcpp::List price_geometric_asian_mc_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, int n_simulations, std::string option_type, int seed, int n_fixed, double fixed_sum, double fixed_log_sum);
+RcppExport SEXP _AsianOptPI_price_geometric_asian_mc_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP n_simulationsSEXP, SEXP option_typeSEXP, SEXP seedSEXP, SEXP n_fixedSEXP, SEXP fixed_sumSEXP, SEXP fixed_log_sumSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -129,13 +260,124 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< int >::type n_simulations(n_simulationsSEXP);
     Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
     Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
-    rcpp_result_gen = Rcpp::wrap(price_geometric_asian_mc_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, n_simulations, option_type, seed));
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_sum(fixed_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_log_sum(fixed_log_sumSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_geometric_asian_mc_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, n_simulations, option_type, seed, n_fixed, fixed_sum, fixed_log_sum));
+    return rcpp_result_gen;
+END_RCPP
+}
+// geometric_distribution_cpp
+SEXP geometric_distribution_cpp(double S0, double r, double u, double d, double lambda, double v_u, double v_d, int n, int n_fixed, double fixed_log_sum, std::string method, double truncation);
+RcppExport SEXP _AsianOptPI_geometric_distribution_cpp(SEXP S0SEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP n_fixedSEXP, SEXP fixed_log_sumSEXP, SEXP methodSEXP, SEXP truncationSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_log_sum(fixed_log_sumSEXP);
+    Rcpp::traits::input_parameter< std::string >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< double >::type truncation(truncationSEXP);
+    rcpp_result_gen = Rcpp::wrap(geometric_distribution_cpp(S0, r, u, d, lambda, v_u, v_d, n, n_fixed, fixed_log_sum, method, truncation));
+    return rcpp_result_gen;
+END_RCPP
+}
+// geometric_ladder_cpp
+Rcpp::List geometric_ladder_cpp(SEXP dist, Rcpp::NumericVector K, std::vector<std::string> option_type);
+RcppExport SEXP _AsianOptPI_geometric_ladder_cpp(SEXP distSEXP, SEXP KSEXP, SEXP option_typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type dist(distSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type K(KSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type option_type(option_typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(geometric_ladder_cpp(dist, K, option_type));
+    return rcpp_result_gen;
+END_RCPP
+}
+// geometric_support_cpp
+Rcpp::List geometric_support_cpp(SEXP dist);
+RcppExport SEXP _AsianOptPI_geometric_support_cpp(SEXP distSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type dist(distSEXP);
+    rcpp_result_gen = Rcpp::wrap(geometric_support_cpp(dist));
+    return rcpp_result_gen;
+END_RCPP
+}
+// geometric_sampler_cpp
+SEXP geometric_sampler_cpp(double S0, double r, double u, double d, double lambda, double v_u, double v_d, int n, int n_fixed, double fixed_log_sum);
+RcppExport SEXP _AsianOptPI_geometric_sampler_cpp(SEXP S0SEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP n_fixedSEXP, SEXP fixed_log_sumSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_log_sum(fixed_log_sumSEXP);
+    rcpp_result_gen = Rcpp::wrap(geometric_sampler_cpp(S0, r, u, d, lambda, v_u, v_d, n, n_fixed, fixed_log_sum));
+    return rcpp_result_gen;
+END_RCPP
+}
+// geometric_sampler_draw_cpp
+Rcpp::List geometric_sampler_draw_cpp(SEXP sampler, int n_samples, int seed);
+RcppExport SEXP _AsianOptPI_geometric_sampler_draw_cpp(SEXP samplerSEXP, SEXP n_samplesSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type sampler(samplerSEXP);
+    Rcpp::traits::input_parameter< int >::type n_samples(n_samplesSEXP);
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(geometric_sampler_draw_cpp(sampler, n_samples, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hedge_backtest_cpp
+Rcpp::List hedge_backtest_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, int n_paths, std::string option_type, std::string paths, double p_up, double drift, double vol, double notional, double cost_lambda, int seed, int n_threads);
+RcppExport SEXP _AsianOptPI_hedge_backtest_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP n_pathsSEXP, SEXP option_typeSEXP, SEXP pathsSEXP, SEXP p_upSEXP, SEXP driftSEXP, SEXP volSEXP, SEXP notionalSEXP, SEXP cost_lambdaSEXP, SEXP seedSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type K(KSEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< int >::type n_paths(n_pathsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type paths(pathsSEXP);
+    Rcpp::traits::input_parameter< double >::type p_up(p_upSEXP);
+    Rcpp::traits::input_parameter< double >::type drift(driftSEXP);
+    Rcpp::traits::input_parameter< double >::type vol(volSEXP);
+    Rcpp::traits::input_parameter< double >::type notional(notionalSEXP);
+    Rcpp::traits::input_parameter< double >::type cost_lambda(cost_lambdaSEXP);
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< int >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(hedge_backtest_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, n_paths, option_type, paths, p_up, drift, vol, notional, cost_lambda, seed, n_threads));
     return rcpp_result_gen;
 END_RCPP
 }
 // price_kemna_vorst_arithmetic_cpp
-List price_kemna_vorst_arithmetic_cpp(double S0, double K, double r, double sigma, double T0, double T, int n, int M, std::string option_type, bool use_control_variate, int seed);
-RcppExport SEXP _AsianOptPI_price_kemna_vorst_arithmetic_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP sigmaSEXP, SEXP T0SEXP, SEXP TSEXP, SEXP nSEXP, SEXP MSEXP, SEXP option_typeSEXP, SEXP use_control_variateSEXP, SEXP seedSEXP) {
+List price_kemna_vorst_arithmetic_cpp(double S0, double K, double r, double sigma, double T0, double T, int n, int M, std::string option_type, bool use_control_variate, int seed, int n_fixed, double fixed_sum, double fixed_log_sum);
+RcppExport SEXP _AsianOptPI_price_kemna_vorst_arithmetic_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP sigmaSEXP, SEXP T0SEXP, SEXP TSEXP, SEXP nSEXP, SEXP MSEXP, SEXP option_typeSEXP, SEXP use_control_variateSEXP, SEXP seedSEXP, SEXP n_fixedSEXP, SEXP fixed_sumSEXP, SEXP fixed_log_sumSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -150,13 +392,16 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
     Rcpp::traits::input_parameter< bool >::type use_control_variate(use_control_variateSEXP);
     Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
-    rcpp_result_gen = Rcpp::wrap(price_kemna_vorst_arithmetic_cpp(S0, K, r, sigma, T0, T, n, M, option_type, use_control_variate, seed));
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_sum(fixed_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_log_sum(fixed_log_sumSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_kemna_vorst_arithmetic_cpp(S0, K, r, sigma, T0, T, n, M, option_type, use_control_variate, seed, n_fixed, fixed_sum, fixed_log_sum));
     return rcpp_result_gen;
 END_RCPP
 }
 // price_kemna_vorst_arithmetic_binomial_cpp
-List price_kemna_vorst_arithmetic_binomial_cpp(double S0, double K, double r, double u, double d, int n, int M, std::string option_type, bool use_control_variate, int seed);
-RcppExport SEXP _AsianOptPI_price_kemna_vorst_arithmetic_binomial_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP nSEXP, SEXP MSEXP, SEXP option_typeSEXP, SEXP use_control_variateSEXP, SEXP seedSEXP) {
+List price_kemna_vorst_arithmetic_binomial_cpp(double S0, double K, double r, double u, double d, int n, int M, std::string option_type, bool use_control_variate, int seed, int n_fixed, double fixed_sum, double fixed_log_sum);
+RcppExport SEXP _AsianOptPI_price_kemna_vorst_arithmetic_binomial_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP nSEXP, SEXP MSEXP, SEXP option_typeSEXP, SEXP use_control_variateSEXP, SEXP seedSEXP, SEXP n_fixedSEXP, SEXP fixed_sumSEXP, SEXP fixed_log_sumSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -170,24 +415,384 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
     Rcpp::traits::input_parameter< bool >::type use_control_variate(use_control_variateSEXP);
     Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
-    rcpp_result_gen = Rcpp::wrap(price_kemna_vorst_arithmetic_binomial_cpp(S0, K, r, u, d, n, M, option_type, use_control_variate, seed));
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_sum(fixed_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_log_sum(fixed_log_sumSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_kemna_vorst_arithmetic_binomial_cpp(S0, K, r, u, d, n, M, option_type, use_control_variate, seed, n_fixed, fixed_sum, fixed_log_sum));
+    return rcpp_result_gen;
+END_RCPP
+}
+// live_book_create_cpp
+SEXP live_book_create_cpp(Rcpp::NumericVector K, Rcpp::IntegerVector n, std::vector<std::string> option_type, Rcpp::IntegerVector underlying, Rcpp::NumericVector spot, double r, double u, double d, double lambda, double v_u, double v_d, Rcpp::IntegerVector n_fixed, Rcpp::NumericVector fixed_log_sum);
+RcppExport SEXP _AsianOptPI_live_book_create_cpp(SEXP KSEXP, SEXP nSEXP, SEXP option_typeSEXP, SEXP underlyingSEXP, SEXP spotSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP n_fixedSEXP, SEXP fixed_log_sumSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type K(KSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type n(nSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type option_type(option_typeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type underlying(underlyingSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type spot(spotSEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type fixed_log_sum(fixed_log_sumSEXP);
+    rcpp_result_gen = Rcpp::wrap(live_book_create_cpp(K, n, option_type, underlying, spot, r, u, d, lambda, v_u, v_d, n_fixed, fixed_log_sum));
+    return rcpp_result_gen;
+END_RCPP
+}
+// live_book_update_cpp
+int live_book_update_cpp(SEXP book, Rcpp::IntegerVector underlying, Rcpp::NumericVector spot);
+RcppExport SEXP _AsianOptPI_live_book_update_cpp(SEXP bookSEXP, SEXP underlyingSEXP, SEXP spotSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type book(bookSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type underlying(underlyingSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type spot(spotSEXP);
+    rcpp_result_gen = Rcpp::wrap(live_book_update_cpp(book, underlying, spot));
+    return rcpp_result_gen;
+END_RCPP
+}
+// live_book_roll_cpp
+int live_book_roll_cpp(SEXP book, Rcpp::IntegerVector moves);
+RcppExport SEXP _AsianOptPI_live_book_roll_cpp(SEXP bookSEXP, SEXP movesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type book(bookSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type moves(movesSEXP);
+    rcpp_result_gen = Rcpp::wrap(live_book_roll_cpp(book, moves));
+    return rcpp_result_gen;
+END_RCPP
+}
+// live_book_state_cpp
+Rcpp::List live_book_state_cpp(SEXP book);
+RcppExport SEXP _AsianOptPI_live_book_state_cpp(SEXP bookSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type book(bookSEXP);
+    rcpp_result_gen = Rcpp::wrap(live_book_state_cpp(book));
+    return rcpp_result_gen;
+END_RCPP
+}
+// price_asian_lsmc_cpp
+Rcpp::List price_asian_lsmc_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, Rcpp::IntegerVector exercise, int n_paths, std::string option_type, std::string average, int degree, int seed, int n_threads);
+RcppExport SEXP _AsianOptPI_price_asian_lsmc_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP exerciseSEXP, SEXP n_pathsSEXP, SEXP option_typeSEXP, SEXP averageSEXP, SEXP degreeSEXP, SEXP seedSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type K(KSEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type exercise(exerciseSEXP);
+    Rcpp::traits::input_parameter< int >::type n_paths(n_pathsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type average(averageSEXP);
+    Rcpp::traits::input_parameter< int >::type degree(degreeSEXP);
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< int >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_asian_lsmc_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, exercise, n_paths, option_type, average, degree, seed, n_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// price_kemna_vorst_lsmc_cpp
+Rcpp::List price_kemna_vorst_lsmc_cpp(double S0, double K, double r, double sigma, double T, int n, Rcpp::IntegerVector exercise, int n_paths, std::string option_type, std::string average, int degree, int seed, int n_threads);
+RcppExport SEXP _AsianOptPI_price_kemna_vorst_lsmc_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP sigmaSEXP, SEXP TSEXP, SEXP nSEXP, SEXP exerciseSEXP, SEXP n_pathsSEXP, SEXP option_typeSEXP, SEXP averageSEXP, SEXP degreeSEXP, SEXP seedSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type K(KSEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type sigma(sigmaSEXP);
+    Rcpp::traits::input_parameter< double >::type T(TSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type exercise(exerciseSEXP);
+    Rcpp::traits::input_parameter< int >::type n_paths(n_pathsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type average(averageSEXP);
+    Rcpp::traits::input_parameter< int >::type degree(degreeSEXP);
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< int >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_kemna_vorst_lsmc_cpp(S0, K, r, sigma, T, n, exercise, n_paths, option_type, average, degree, seed, n_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// path_vectors_cpp
+Rcpp::List path_vectors_cpp(double S0, double r, double u, double d, double lambda, double v_u, double v_d, int n, int n_fixed, double fixed_sum, double fixed_log_sum, double fixed_min, double fixed_max);
+RcppExport SEXP _AsianOptPI_path_vectors_cpp(SEXP S0SEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP n_fixedSEXP, SEXP fixed_sumSEXP, SEXP fixed_log_sumSEXP, SEXP fixed_minSEXP, SEXP fixed_maxSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_sum(fixed_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_log_sum(fixed_log_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_min(fixed_minSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_max(fixed_maxSEXP);
+    rcpp_result_gen = Rcpp::wrap(path_vectors_cpp(S0, r, u, d, lambda, v_u, v_d, n, n_fixed, fixed_sum, fixed_log_sum, fixed_min, fixed_max));
+    return rcpp_result_gen;
+END_RCPP
+}
+// payoff_distribution_cpp
+Rcpp::List payoff_distribution_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, Rcpp::NumericVector probs, std::string option_type, std::string average, std::string method, int n_simulations, int seed, int n_fixed, double fixed_sum, double fixed_log_sum, double accuracy);
+RcppExport SEXP _AsianOptPI_payoff_distribution_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP probsSEXP, SEXP option_typeSEXP, SEXP averageSEXP, SEXP methodSEXP, SEXP n_simulationsSEXP, SEXP seedSEXP, SEXP n_fixedSEXP, SEXP fixed_sumSEXP, SEXP fixed_log_sumSEXP, SEXP accuracySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type K(KSEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type probs(probsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type average(averageSEXP);
+    Rcpp::traits::input_parameter< std::string >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< int >::type n_simulations(n_simulationsSEXP);
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_sum(fixed_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_log_sum(fixed_log_sumSEXP);
+    Rcpp::traits::input_parameter< double >::type accuracy(accuracySEXP);
+    rcpp_result_gen = Rcpp::wrap(payoff_distribution_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, probs, option_type, average, method, n_simulations, seed, n_fixed, fixed_sum, fixed_log_sum, accuracy));
+    return rcpp_result_gen;
+END_RCPP
+}
+// prepare_model_cpp
+SEXP prepare_model_cpp(double r, double u, double d, double lambda, double v_u, double v_d, int n, bool arithmetic);
+RcppExport SEXP _AsianOptPI_prepare_model_cpp(SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP arithmeticSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< bool >::type arithmetic(arithmeticSEXP);
+    rcpp_result_gen = Rcpp::wrap(prepare_model_cpp(r, u, d, lambda, v_u, v_d, n, arithmetic));
+    return rcpp_result_gen;
+END_RCPP
+}
+// prepared_price_cpp
+Rcpp::NumericVector prepared_price_cpp(SEXP model, Rcpp::NumericVector S0, Rcpp::NumericVector K, std::vector<std::string> option_type, std::string engine, int n_threads);
+RcppExport SEXP _AsianOptPI_prepared_price_cpp(SEXP modelSEXP, SEXP S0SEXP, SEXP KSEXP, SEXP option_typeSEXP, SEXP engineSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type model(modelSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type K(KSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type option_type(option_typeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type engine(engineSEXP);
+    Rcpp::traits::input_parameter< int >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(prepared_price_cpp(model, S0, K, option_type, engine, n_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// prepared_bounds_cpp
+Rcpp::List prepared_bounds_cpp(SEXP model, Rcpp::NumericVector S0, Rcpp::NumericVector K, std::vector<std::string> option_type);
+RcppExport SEXP _AsianOptPI_prepared_bounds_cpp(SEXP modelSEXP, SEXP S0SEXP, SEXP KSEXP, SEXP option_typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type model(modelSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type K(KSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type option_type(option_typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(prepared_bounds_cpp(model, S0, K, option_type));
+    return rcpp_result_gen;
+END_RCPP
+}
+// price_range_accrual_cpp
+Rcpp::List price_range_accrual_cpp(double S0, double r, double u, double d, double lambda, double v_u, double v_d, int n, double lower, double upper, Rcpp::NumericVector count_payoff, int n_fixed, int fixed_inside);
+RcppExport SEXP _AsianOptPI_price_range_accrual_cpp(SEXP S0SEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP lowerSEXP, SEXP upperSEXP, SEXP count_payoffSEXP, SEXP n_fixedSEXP, SEXP fixed_insideSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< double >::type lower(lowerSEXP);
+    Rcpp::traits::input_parameter< double >::type upper(upperSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type count_payoff(count_payoffSEXP);
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< int >::type fixed_inside(fixed_insideSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_range_accrual_cpp(S0, r, u, d, lambda, v_u, v_d, n, lower, upper, count_payoff, n_fixed, fixed_inside));
+    return rcpp_result_gen;
+END_RCPP
+}
+// price_regime_switching_cpp
+Rcpp::List price_regime_switching_cpp(double S0, double K, double r, double u, double d, Rcpp::NumericVector lambda, Rcpp::NumericVector v_u, Rcpp::NumericVector v_d, Rcpp::NumericMatrix transition, Rcpp::NumericVector initial, int n, std::string option_type, std::string payoff, int grid_points, int n_fixed, double fixed_log_sum);
+RcppExport SEXP _AsianOptPI_price_regime_switching_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP transitionSEXP, SEXP initialSEXP, SEXP nSEXP, SEXP option_typeSEXP, SEXP payoffSEXP, SEXP grid_pointsSEXP, SEXP n_fixedSEXP, SEXP fixed_log_sumSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type K(KSEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type transition(transitionSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type initial(initialSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type payoff(payoffSEXP);
+    Rcpp::traits::input_parameter< int >::type grid_points(grid_pointsSEXP);
+    Rcpp::traits::input_parameter< int >::type n_fixed(n_fixedSEXP);
+    Rcpp::traits::input_parameter< double >::type fixed_log_sum(fixed_log_sumSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_regime_switching_cpp(S0, K, r, u, d, lambda, v_u, v_d, transition, initial, n, option_type, payoff, grid_points, n_fixed, fixed_log_sum));
+    return rcpp_result_gen;
+END_RCPP
+}
+// scratch_arena_stats_cpp
+Rcpp::List scratch_arena_stats_cpp();
+RcppExport SEXP _AsianOptPI_scratch_arena_stats_cpp() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(scratch_arena_stats_cpp());
+    return rcpp_result_gen;
+END_RCPP
+}
+// price_tarf_cpp
+Rcpp::List price_tarf_cpp(double S0, double K, double r, double u, double d, double lambda, double v_u, double v_d, int n, double target, double leverage, std::string option_type, std::string knockout, double accrued, std::string method, int grid_points, std::string interpolation, int n_simulations, int seed);
+RcppExport SEXP _AsianOptPI_price_tarf_cpp(SEXP S0SEXP, SEXP KSEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP, SEXP targetSEXP, SEXP leverageSEXP, SEXP option_typeSEXP, SEXP knockoutSEXP, SEXP accruedSEXP, SEXP methodSEXP, SEXP grid_pointsSEXP, SEXP interpolationSEXP, SEXP n_simulationsSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type K(KSEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< double >::type target(targetSEXP);
+    Rcpp::traits::input_parameter< double >::type leverage(leverageSEXP);
+    Rcpp::traits::input_parameter< std::string >::type option_type(option_typeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type knockout(knockoutSEXP);
+    Rcpp::traits::input_parameter< double >::type accrued(accruedSEXP);
+    Rcpp::traits::input_parameter< std::string >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< int >::type grid_points(grid_pointsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type interpolation(interpolationSEXP);
+    Rcpp::traits::input_parameter< int >::type n_simulations(n_simulationsSEXP);
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(price_tarf_cpp(S0, K, r, u, d, lambda, v_u, v_d, n, target, leverage, option_type, knockout, accrued, method, grid_points, interpolation, n_simulations, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// terminal_distribution_cpp
+SEXP terminal_distribution_cpp(double S0, double r, double u, double d, double lambda, double v_u, double v_d, int n);
+RcppExport SEXP _AsianOptPI_terminal_distribution_cpp(SEXP S0SEXP, SEXP rSEXP, SEXP uSEXP, SEXP dSEXP, SEXP lambdaSEXP, SEXP v_uSEXP, SEXP v_dSEXP, SEXP nSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type S0(S0SEXP);
+    Rcpp::traits::input_parameter< double >::type r(rSEXP);
+    Rcpp::traits::input_parameter< double >::type u(uSEXP);
+    Rcpp::traits::input_parameter< double >::type d(dSEXP);
+    Rcpp::traits::input_parameter< double >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< double >::type v_u(v_uSEXP);
+    Rcpp::traits::input_parameter< double >::type v_d(v_dSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    rcpp_result_gen = Rcpp::wrap(terminal_distribution_cpp(S0, r, u, d, lambda, v_u, v_d, n));
+    return rcpp_result_gen;
+END_RCPP
+}
+// terminal_ladder_cpp
+Rcpp::List terminal_ladder_cpp(SEXP dist, Rcpp::NumericVector K, std::vector<std::string> option_type);
+RcppExport SEXP _AsianOptPI_terminal_ladder_cpp(SEXP distSEXP, SEXP KSEXP, SEXP option_typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type dist(distSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type K(KSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type option_type(option_typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(terminal_ladder_cpp(dist, K, option_type));
     return rcpp_result_gen;
 END_RCPP
 }
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_AsianOptPI_arithmetic_asian_bounds_cpp", (DL_FUNC) &_AsianOptPI_arithmetic_asian_bounds_cpp, 10},
-    {"_AsianOptPI_arithmetic_asian_bounds_extended_cpp", (DL_FUNC) &_AsianOptPI_arithmetic_asian_bounds_extended_cpp, 13},
+    {"_AsianOptPI_price_geometric_asian_american_cpp", (DL_FUNC) &_AsianOptPI_price_geometric_asian_american_cpp, 13},
+    {"_AsianOptPI_price_arithmetic_asian_cpp", (DL_FUNC) &_AsianOptPI_price_arithmetic_asian_cpp, 13},
+    {"_AsianOptPI_arithmetic_asian_bounds_cpp", (DL_FUNC) &_AsianOptPI_arithmetic_asian_bounds_cpp, 15},
+    {"_AsianOptPI_arithmetic_asian_bounds_extended_cpp", (DL_FUNC) &_AsianOptPI_arithmetic_asian_bounds_extended_cpp, 18},
+    {"_AsianOptPI_price_bid_ask_cpp", (DL_FUNC) &_AsianOptPI_price_bid_ask_cpp, 17},
+    {"_AsianOptPI_price_book_impact_cpp", (DL_FUNC) &_AsianOptPI_price_book_impact_cpp, 15},
     {"_AsianOptPI_price_european_call_cpp", (DL_FUNC) &_AsianOptPI_price_european_call_cpp, 9},
     {"_AsianOptPI_price_european_put_cpp", (DL_FUNC) &_AsianOptPI_price_european_put_cpp, 9},
-    {"_AsianOptPI_price_geometric_asian_cpp", (DL_FUNC) &_AsianOptPI_price_geometric_asian_cpp, 10},
-    {"_AsianOptPI_price_geometric_asian_mc_cpp", (DL_FUNC) &_AsianOptPI_price_geometric_asian_mc_cpp, 12},
-    {"_AsianOptPI_price_kemna_vorst_arithmetic_cpp", (DL_FUNC) &_AsianOptPI_price_kemna_vorst_arithmetic_cpp, 11},
-    {"_AsianOptPI_price_kemna_vorst_arithmetic_binomial_cpp", (DL_FUNC) &_AsianOptPI_price_kemna_vorst_arithmetic_binomial_cpp, 10},
+    {"_AsianOptPI_price_european_batch_cpp", (DL_FUNC) &_AsianOptPI_price_european_batch_cpp, 10},
+    {"_AsianOptPI_price_geometric_asian_cpp", (DL_FUNC) &_AsianOptPI_price_geometric_asian_cpp, 13},
+    {"_AsianOptPI_price_geometric_asian_mc_cpp", (DL_FUNC) &_AsianOptPI_price_geometric_asian_mc_cpp, 15},
+    {"_AsianOptPI_geometric_distribution_cpp", (DL_FUNC) &_AsianOptPI_geometric_distribution_cpp, 12},
+    {"_AsianOptPI_geometric_ladder_cpp", (DL_FUNC) &_AsianOptPI_geometric_ladder_cpp, 3},
+    {"_AsianOptPI_geometric_support_cpp", (DL_FUNC) &_AsianOptPI_geometric_support_cpp, 1},
+    {"_AsianOptPI_geometric_sampler_cpp", (DL_FUNC) &_AsianOptPI_geometric_sampler_cpp, 10},
+    {"_AsianOptPI_geometric_sampler_draw_cpp", (DL_FUNC) &_AsianOptPI_geometric_sampler_draw_cpp, 3},
+    {"_AsianOptPI_hedge_backtest_cpp", (DL_FUNC) &_AsianOptPI_hedge_backtest_cpp, 19},
+    {"_AsianOptPI_price_kemna_vorst_arithmetic_cpp", (DL_FUNC) &_AsianOptPI_price_kemna_vorst_arithmetic_cpp, 14},
+    {"_AsianOptPI_price_kemna_vorst_arithmetic_binomial_cpp", (DL_FUNC) &_AsianOptPI_price_kemna_vorst_arithmetic_binomial_cpp, 13},
+    {"_AsianOptPI_live_book_create_cpp", (DL_FUNC) &_AsianOptPI_live_book_create_cpp, 13},
+    {"_AsianOptPI_live_book_update_cpp", (DL_FUNC) &_AsianOptPI_live_book_update_cpp, 3},
+    {"_AsianOptPI_live_book_roll_cpp", (DL_FUNC) &_AsianOptPI_live_book_roll_cpp, 2},
+    {"_AsianOptPI_live_book_state_cpp", (DL_FUNC) &_AsianOptPI_live_book_state_cpp, 1},
+    {"_AsianOptPI_price_asian_lsmc_cpp", (DL_FUNC) &_AsianOptPI_price_asian_lsmc_cpp, 16},
+    {"_AsianOptPI_price_kemna_vorst_lsmc_cpp", (DL_FUNC) &_AsianOptPI_price_kemna_vorst_lsmc_cpp, 13},
+    {"_AsianOptPI_path_vectors_cpp", (DL_FUNC) &_AsianOptPI_path_vectors_cpp, 13},
+    {"_AsianOptPI_payoff_distribution_cpp", (DL_FUNC) &_AsianOptPI_payoff_distribution_cpp, 19},
+    {"_AsianOptPI_prepare_model_cpp", (DL_FUNC) &_AsianOptPI_prepare_model_cpp, 8},
+    {"_AsianOptPI_prepared_price_cpp", (DL_FUNC) &_AsianOptPI_prepared_price_cpp, 6},
+    {"_AsianOptPI_prepared_bounds_cpp", (DL_FUNC) &_AsianOptPI_prepared_bounds_cpp, 4},
+    {"_AsianOptPI_price_range_accrual_cpp", (DL_FUNC) &_AsianOptPI_price_range_accrual_cpp, 13},
+    {"_AsianOptPI_price_regime_switching_cpp", (DL_FUNC) &_AsianOptPI_price_regime_switching_cpp, 16},
+    {"_AsianOptPI_scratch_arena_stats_cpp", (DL_FUNC) &_AsianOptPI_scratch_arena_stats_cpp, 0},
+    {"_AsianOptPI_price_tarf_cpp", (DL_FUNC) &_AsianOptPI_price_tarf_cpp, 19},
+    {"_AsianOptPI_terminal_distribution_cpp", (DL_FUNC) &_AsianOptPI_terminal_distribution_cpp, 8},
+    {"_AsianOptPI_terminal_ladder_cpp", (DL_FUNC) &_AsianOptPI_terminal_ladder_cpp, 3},
     {NULL, NULL, 0}
 };
 
+void register_path_vectors(DllInfo* dll);
 RcppExport void R_init_AsianOptPI(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    register_path_vectors(dll);
 }
@@ -0,0 +1,240 @@
+#include <Rcpp.h>
+#include "utils.h"
+#include "spill_file.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// State of the geometric Asian after t steps: j ups so far and the
+// cumulative up-count C = sum_{i<=t} U_i, which fixes the running log-sum
+//   sum_{i=0}^t log S_i = (t+1) log S0 + t(t+1)/2 log d_tilde + C log(u_tilde/d_tilde).
+// For given (t, j), C runs from j(j+1)/2 (ups last) to jt - j(j-1)/2 (ups
+// first), so a layer has sum_j (j(t-j) + 1) = O(t^3) states.
+static inline long long cumulative_min(int j) {
+    return (long long)j * (j + 1) / 2;
+}
+
+static inline long long cumulative_max(int t, int j) {
+    return (long long)j * t - (long long)j * (j - 1) / 2;
+}
+
+// offsets[j] = index of (j, cumulative_min(j)) in layer t; offsets[t+1] is
+// the layer size
+static void layer_offsets(int t, std::vector<long long>& offsets) {
+    offsets.resize(t + 2);
+    offsets[0] = 0;
+    for (int j = 0; j <= t; ++j) {
+        offsets[j + 1] = offsets[j] + (cumulative_max(t, j) - cumulative_min(j) + 1);
+    }
+}
+
+//' Price an American or Bermudan Geometric Asian Option with Price Impact
+//'
+//' Computes the exact early-exercise price of a geometric Asian option by
+//' backward induction over the compressed state space of the binomial tree
+//' with price impact.
+//'
+//' @param S0 Initial stock price (positive)
+//' @param K Strike price (positive)
+//' @param r Gross risk-free rate per period
+//' @param u Base up factor in CRR model
+//' @param d Base down factor in CRR model
+//' @param lambda Price impact coefficient (non-negative)
+//' @param v_u Hedging volume on up move (non-negative)
+//' @param v_d Hedging volume on down move (non-negative)
+//' @param n Number of time steps (positive integer)
+//' @param exercise Steps (in 1..n) at which exercise is allowed; maturity is
+//'   always included and an empty vector allows every step
+//' @param option_type "call" or "put"
+//' @param memory_budget Bytes of DP layers to hold in memory (default: Inf)
+//' @param scratch_dir Directory for the scratch files of the layers beyond
+//'   the budget
+//'
+//' @return List with \code{price}, \code{european_price}, the exercise
+//'   boundary as vectors \code{boundary_step}, \code{boundary_level},
+//'   \code{boundary_spot} and \code{boundary_average}, and
+//'   \code{spilled_layers}, the number of layers kept in scratch files
+//'
+//' @details
+//' Exercising at step \eqn{t} pays \eqn{\max(0, G_t - K)} (call) or
+//' \eqn{\max(0, K - G_t)} (put), with \eqn{G_t} the geometric average of
+//' \eqn{S_0, \ldots, S_t}. The state after \eqn{t} steps is the number of up
+//' moves \eqn{j} and the cumulative up-count \eqn{C = \sum_{i \le t} U_i},
+//' which determines \eqn{G_t}; at maturity \eqn{C} is the weighted up-count
+//' \eqn{W} of the European engine. Each step has \eqn{O(t^3)} states, so the
+//' induction costs \eqn{O(n^4)} time and \eqn{O(n^3)} memory.
+//'
+//' For each exercise step and level \eqn{j} (spot
+//' \eqn{S_0 \tilde{u}^j \tilde{d}^{t-j}}) the boundary is the smallest
+//' (call) or largest (put) \eqn{G_t} at which exercise is optimal; levels
+//' with no exercise are omitted.
+//'
+//' The induction keeps four layers of \eqn{O(n^3)} values. Layers that do
+//' not fit \code{memory_budget} are memory-mapped from scratch files; every
+//' step sweeps them in order, so the kernel streams their pages from disk.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List price_geometric_asian_american_cpp(
+    double S0, double K, double r, double u, double d,
+    double lambda, double v_u, double v_d, int n,
+    Rcpp::IntegerVector exercise,
+    std::string option_type = "call",
+    double memory_budget = R_PosInf,
+    std::string scratch_dir = ""
+) {
+    if (n <= 0) {
+        Rcpp::stop("n must be a positive integer");
+    }
+    if (option_type != "call" && option_type != "put") {
+        Rcpp::stop("option_type must be either 'call' or 'put'");
+    }
+
+    std::vector<bool> exercisable = exercise_schedule(n, exercise);
+
+    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+    bool is_call = (option_type == "call");
+
+    double p = factors.p_adj;
+    double q = 1.0 - p;
+    double discount = 1.0 / r;
+    double log_S0 = std::log(S0);
+    double log_u = std::log(factors.u_tilde);
+    double log_d = std::log(factors.d_tilde);
+    double log_ratio = log_u - log_d;
+
+    std::vector<long long> offsets;
+    layer_offsets(n, offsets);
+    long long max_states = offsets[n + 1];
+
+    // Two layers for the American values and two for the European ones, in
+    // memory while they fit the budget and in scratch files beyond it. The
+    // resident layers are heap buffers freed on return rather than arena
+    // blocks, so memory_budget bounds what the call leaves behind too.
+    std::vector<double> resident[4];
+    SpillFile spill[4];
+    double* layers[4];
+    double layer_bytes = (double)max_states * sizeof(double);
+    int spilled_layers = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        if ((i + 1) * layer_bytes <= memory_budget) {
+            resident[i].resize(max_states);
+            layers[i] = resident[i].data();
+        } else {
+            if (scratch_dir.empty()) {
+                Rcpp::stop("scratch_dir is required when the layers exceed memory_budget");
+            }
+            layers[i] = spill[i].map(max_states, scratch_dir);
+            ++spilled_layers;
+        }
+    }
+
+    double* next = layers[0];
+    double* current = layers[1];
+    double* next_euro = layers[2];
+    double* current_euro = layers[3];
+
+    std::vector<int> boundary_step;
+    std::vector<int> boundary_level;
+    std::vector<double> boundary_spot;
+    std::vector<double> boundary_average;
+
+    // Geometric average G_t of state (t, C)
+    auto average = [&](int t, long long C) {
+        return std::exp(log_S0 + 0.5 * t * log_d + C * log_ratio / (t + 1));
+    };
+
+    for (int j = 0; j <= n; ++j) {
+        long long c0 = cumulative_min(j);
+        long long c1 = cumulative_max(n, j);
+        double* v = next + offsets[j];
+        double* e = next_euro + offsets[j];
+        bool found = false;
+        double exercised = 0.0;
+
+        for (long long C = c0; C <= c1; ++C) {
+            double G = average(n, C);
+            double payoff = is_call ? std::max(0.0, G - K) : std::max(0.0, K - G);
+            v[C - c0] = payoff;
+            e[C - c0] = payoff;
+            if (payoff > 0.0 && (!found || (is_call ? G < exercised : G > exercised))) {
+                found = true;
+                exercised = G;
+            }
+        }
+
+        if (found) {
+            boundary_step.push_back(n);
+            boundary_level.push_back(j);
+            boundary_spot.push_back(std::exp(log_S0 + j * log_u + (n - j) * log_d));
+            boundary_average.push_back(exercised);
+        }
+    }
+
+    std::vector<long long> child_offsets = offsets;
+
+    for (int t = n - 1; t >= 0; --t) {
+        layer_offsets(t, offsets);
+        bool can_exercise = exercisable[t];
+
+        for (int j = 0; j <= t; ++j) {
+            long long c0 = cumulative_min(j);
+            long long c1 = cumulative_max(t, j);
+            // Children (t+1, j+1, C+j+1) and (t+1, j, C+j), and this state,
+            // as layer indices relative to C
+            long long up = child_offsets[j + 1] - cumulative_min(j + 1) + j + 1;
+            long long down = child_offsets[j] - cumulative_min(j) + j;
+            long long here = offsets[j] - c0;
+            bool found = false;
+            double exercised = 0.0;
+
+            for (long long C = c0; C <= c1; ++C) {
+                double continuation = discount * (p * next[up + C] + q * next[down + C]);
+                current_euro[here + C] = discount * (p * next_euro[up + C] +
+                                                     q * next_euro[down + C]);
+
+                if (can_exercise) {
+                    double G = average(t, C);
+                    double payoff = is_call ? G - K : K - G;
+                    if (payoff > 0.0 && payoff >= continuation) {
+                        current[here + C] = payoff;
+                        if (!found || (is_call ? G < exercised : G > exercised)) {
+                            found = true;
+                            exercised = G;
+                        }
+                        continue;
+                    }
+                }
+                current[here + C] = continuation;
+            }
+
+            if (found) {
+                boundary_step.push_back(t);
+                boundary_level.push_back(j);
+                boundary_spot.push_back(std::exp(log_S0 + j * log_u + (t - j) * log_d));
+                boundary_average.push_back(exercised);
+            }
+        }
+
+        std::swap(next, current);
+        std::swap(next_euro, current_euro);
+        child_offsets = offsets;
+    }
+
+    // The boundary was collected from maturity backwards
+    std::reverse(boundary_step.begin(), boundary_step.end());
+    std::reverse(boundary_level.begin(), boundary_level.end());
+    std::reverse(boundary_spot.begin(), boundary_spot.end());
+    std::reverse(boundary_average.begin(), boundary_average.end());
+
+    return Rcpp::List::create(
+        Rcpp::Named("price") = next[0],
+        Rcpp::Named("european_price") = next_euro[0],
+        Rcpp::Named("boundary_step") = boundary_step,
+        Rcpp::Named("boundary_level") = boundary_level,
+        Rcpp::Named("boundary_spot") = boundary_spot,
+        Rcpp::Named("boundary_average") = boundary_average,
+        Rcpp::Named("spilled_layers") = spilled_layers
+    );
+}
@@ -1,13 +1,50 @@
 #include <Rcpp.h>
 #include "utils.h"
+#include "path_enumeration.h"
+#include "path_kernel.h"
 #include <vector>
 #include <cmath>
 #include <algorithm>
 #include <random>
 #include <set>
 
-// External function from geometric_asian.cpp
-std::vector<std::vector<int>> generate_all_paths(int n);
+// Global spread parameter rho* from the widest price range of any path.
+// Unseasoned: M / m = (u_tilde / d_tilde)^n. Seasoned: the range also covers
+// the realized fixings.
+static double compute_global_rho(
+    double S0, int n,
+    const AdjustedFactors& factors,
+    const Seasoning& seasoning
+) {
+    double u_n = std::pow(factors.u_tilde, n);
+    double d_n = std::pow(factors.d_tilde, n);
+
+    if (seasoning.count == 0) {
+        return std::exp(std::pow(u_n - d_n, 2) / (4.0 * u_n * d_n));
+    }
+
+    double S_max = std::max(S0 * u_n, seasoning.max);
+    double S_min = std::min(S0 * d_n, seasoning.min);
+    return std::exp(std::pow(S_max - S_min, 2) / (4.0 * S_min * S_max));
+}
+
+// The bounds need the range of the realized fixings on top of their sums
+static Seasoning make_bounds_seasoning(
+    int n_fixed, double fixed_sum, double fixed_log_sum,
+    double fixed_min, double fixed_max
+) {
+    Seasoning seasoning = make_seasoning(n_fixed, fixed_sum, fixed_log_sum,
+                                         fixed_min, fixed_max);
+
+    if (n_fixed > 0) {
+        if (!R_FINITE(fixed_min) || !R_FINITE(fixed_max) ||
+            fixed_min <= 0 || fixed_max < fixed_min) {
+            Rcpp::stop("fixed_min and fixed_max must satisfy 0 < fixed_min <= fixed_max when n_fixed > 0");
+        }
+    }
+
+    return seasoning;
+}
 
 //' Compute Bounds for Arithmetic Asian Option
 //'
@@ -25,6 +62,12 @@ std::vector<std::vector<int>> generate_all_paths(int n);
 //' @param v_d Hedging volume on down move
 //' @param n Number of time steps
 //' @param option_type Type of option: "call" or "put" (default: "call")
+//' @param n_fixed Number of fixings already realized before \code{S0}
+//'   (default: 0)
+//' @param fixed_sum Sum of the realized fixings (default: 0)
+//' @param fixed_log_sum Sum of the logs of the realized fixings (default: 0)
+//' @param fixed_min Smallest realized fixing (required when \code{n_fixed > 0})
+//' @param fixed_max Largest realized fixing (required when \code{n_fixed > 0})
 //'
 //' @return List containing:
 //' \itemize{
@@ -41,57 +84,37 @@ std::vector<std::vector<int>> generate_all_paths(int n);
 //'
 //' where \eqn{rho^* = \exp((u_{tilde}^n - d_{tilde}^n)^2 / (4 \cdot u_{tilde}^n \cdot d_{tilde}^n))}
 //'
+//' For a seasoned option the realized fixings join the average and the
+//' price range behind \eqn{rho^*} is widened to include
+//' \code{fixed_min} and \code{fixed_max}.
+//'
 //' @export
 // [[Rcpp::export]]
 Rcpp::List arithmetic_asian_bounds_cpp(
     double S0, double K, double r, double u, double d,
     double lambda, double v_u, double v_d, int n,
-    std::string option_type = "call"
+    std::string option_type = "call",
+    int n_fixed = 0, double fixed_sum = 0.0, double fixed_log_sum = 0.0,
+    double fixed_min = NA_REAL, double fixed_max = NA_REAL
 ) {
     if (option_type != "call" && option_type != "put") {
         Rcpp::stop("option_type must be either 'call' or 'put'");
     }
-    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+    Seasoning seasoning = make_bounds_seasoning(n_fixed, fixed_sum, fixed_log_sum,
+                                                fixed_min, fixed_max);
 
-    std::vector<std::vector<int>> all_paths = generate_all_paths(n);
+    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
 
     double discount = std::pow(r, -n);
 
-    double lower_bound = 0.0;
-    double EQ_G = 0.0;
-
-    for (const auto& path : all_paths) {
-        std::vector<double> prices = generate_price_path(S0, path,
-                                                         factors.u_tilde,
-                                                         factors.d_tilde);
-
-        double G = geometric_mean(prices);
+    GeometricSums sums = sum_geometric_payoffs(S0, K, n, factors,
+                                               option_type == "call",
+                                               seasoning);
 
-        double payoff;
-        if (option_type == "call") {
-            payoff = std::max(0.0, G - K);
-        } else {
-            payoff = std::max(0.0, K - G);
-        }
-
-        int n_ups = 0;
-        for (int move : path) {
-            if (move == 1) n_ups++;
-        }
+    double lower_bound = discount * sums.payoff;
+    double EQ_G = sums.G;
 
-        double path_prob = std::pow(factors.p_adj, n_ups) *
-                          std::pow(1.0 - factors.p_adj, n - n_ups);
-
-        lower_bound += path_prob * payoff;
-        EQ_G += path_prob * G;
-    }
-
-    lower_bound *= discount;
-
-    double u_n = std::pow(factors.u_tilde, n);
-    double d_n = std::pow(factors.d_tilde, n);
-    double spread = std::pow(u_n - d_n, 2) / (4.0 * u_n * d_n);
-    double rho_star = std::exp(spread);
+    double rho_star = compute_global_rho(S0, n, factors, seasoning);
 
     double upper_bound = lower_bound + discount * (rho_star - 1.0) * EQ_G;
 
@@ -104,25 +127,11 @@ Rcpp::List arithmetic_asian_bounds_cpp(
     );
 }
 
-// Convert integer index to binary path
-// @param idx Path index (0 to 2^n - 1)
-// @param n Number of steps
-// @return Vector of 0s and 1s representing the path
-std::vector<int> index_to_path(int idx, int n) {
-    std::vector<int> path(n);
-    for (int j = 0; j < n; j++) {
-        path[j] = (idx >> j) & 1;  // Extract j-th bit
-    }
-    return path;
-}
-
 // Compute path-specific rho parameter
-// @param prices Vector of stock prices along the path
+// @param S_min Minimum stock price along the path
+// @param S_max Maximum stock price along the path
 // @return rho(omega) = exp((S_M - S_m)^2 / (4 * S_m * S_M))
-double compute_path_rho(const std::vector<double>& prices) {
-    double S_min = *std::min_element(prices.begin(), prices.end());
-    double S_max = *std::max_element(prices.begin(), prices.end());
-
+double compute_path_rho(double S_min, double S_max) {
     if (S_min <= 0 || S_max <= 0) {
         Rcpp::stop("Invalid prices: all prices must be positive");
     }
@@ -149,6 +158,12 @@ double compute_path_rho(const std::vector<double>& prices) {
 //' @param max_sample_size Maximum number of paths to sample (default 100000)
 //' @param sample_fraction Fraction of paths to sample (default 0.1 = 10\%)
 //' @param option_type Type of option: "call" or "put" (default: "call")
+//' @param n_fixed Number of fixings already realized before \code{S0}
+//'   (default: 0)
+//' @param fixed_sum Sum of the realized fixings (default: 0)
+//' @param fixed_log_sum Sum of the logs of the realized fixings (default: 0)
+//' @param fixed_min Smallest realized fixing (required when \code{n_fixed > 0})
+//' @param fixed_max Largest realized fixing (required when \code{n_fixed > 0})
 //'
 //' @return List with components:
 //' \itemize{
@@ -169,53 +184,29 @@ Rcpp::List arithmetic_asian_bounds_extended_cpp(
     bool compute_path_specific = false,
     int max_sample_size = 100000,
     double sample_fraction = 0.1,
-    std::string option_type = "call"
+    std::string option_type = "call",
+    int n_fixed = 0, double fixed_sum = 0.0, double fixed_log_sum = 0.0,
+    double fixed_min = NA_REAL, double fixed_max = NA_REAL
 ) {
     if (option_type != "call" && option_type != "put") {
         Rcpp::stop("option_type must be either 'call' or 'put'");
     }
 
-    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+    Seasoning seasoning = make_bounds_seasoning(n_fixed, fixed_sum, fixed_log_sum,
+                                                fixed_min, fixed_max);
 
-    std::vector<std::vector<int>> all_paths = generate_all_paths(n);
+    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
 
     double discount = std::pow(r, -n);
 
-    double lower_bound = 0.0;
-    double EQ_G = 0.0;
-
-    for (const auto& path : all_paths) {
-        std::vector<double> prices = generate_price_path(S0, path,
-                                                         factors.u_tilde,
-                                                         factors.d_tilde);
-
-        double G = geometric_mean(prices);
-
-        double payoff;
-        if (option_type == "call") {
-            payoff = std::max(0.0, G - K);
-        } else {
-            payoff = std::max(0.0, K - G);
-        }
-
-        int n_ups = 0;
-        for (int move : path) {
-            if (move == 1) n_ups++;
-        }
-
-        double path_prob = std::pow(factors.p_adj, n_ups) *
-                          std::pow(1.0 - factors.p_adj, n - n_ups);
-
-        lower_bound += path_prob * payoff;
-        EQ_G += path_prob * G;
-    }
+    GeometricSums sums = sum_geometric_payoffs(S0, K, n, factors,
+                                               option_type == "call",
+                                               seasoning);
 
-    lower_bound *= discount;
+    double lower_bound = discount * sums.payoff;
+    double EQ_G = sums.G;
 
-    double u_n = std::pow(factors.u_tilde, n);
-    double d_n = std::pow(factors.d_tilde, n);
-    double spread_global = std::pow(u_n - d_n, 2) / (4.0 * u_n * d_n);
-    double rho_star = std::exp(spread_global);
+    double rho_star = compute_global_rho(S0, n, factors, seasoning);
 
     double upper_bound_global = lower_bound + discount * (rho_star - 1.0) * EQ_G;
 
@@ -231,26 +222,8 @@ Rcpp::List arithmetic_asian_bounds_extended_cpp(
 
         if (n_paths_sampled >= total_paths) {
             n_paths_sampled = total_paths;
-            double sum_path_specific = 0.0;
-
-            for (const auto& path : all_paths) {
-                std::vector<double> prices = generate_price_path(S0, path,
-                                                                 factors.u_tilde,
-                                                                 factors.d_tilde);
-
-                double G = geometric_mean(prices);
-                double rho_omega = compute_path_rho(prices);
-
-                int n_ups = 0;
-                for (int move : path) {
-                    if (move == 1) n_ups++;
-                }
-
-                double path_prob = std::pow(factors.p_adj, n_ups) *
-                                  std::pow(1.0 - factors.p_adj, n - n_ups);
-
-                sum_path_specific += path_prob * (rho_omega - 1.0) * G;
-            }
+            double sum_path_specific = sum_path_specific_spread(S0, n, factors,
+                                                                seasoning);
 
             upper_bound_path_specific = lower_bound + discount * sum_path_specific;
 
@@ -267,25 +240,35 @@ Rcpp::List arithmetic_asian_bounds_extended_cpp(
 
             double sum_path_specific = 0.0;
 
-            for (int idx : sampled_indices) {
-                std::vector<int> path = index_to_path(idx, n);
-
-                std::vector<double> prices = generate_price_path(S0, path,
-                                                                 factors.u_tilde,
-                                                                 factors.d_tilde);
-
-                double G = geometric_mean(prices);
-                double rho_omega = compute_path_rho(prices);
-
-                int n_ups = 0;
-                for (int move : path) {
-                    if (move == 1) n_ups++;
+            ScratchFrame frame;
+            size_t n_batch = sampled_indices.size();
+            long long* batch = frame.allocate<long long>(n_batch);
+            std::copy(sampled_indices.begin(), sampled_indices.end(), batch);
+            unsigned char* moves = frame.allocate<unsigned char>((size_t)n * PATH_LANES);
+            PathLanes lanes;
+            bool seasoned = seasoning.count > 0;
+            double N = seasoning.count + n + 1;
+
+            for (size_t first = 0; first < n_batch; first += PATH_LANES) {
+                int count = (int)std::min((size_t)PATH_LANES, n_batch - first);
+
+                unpack_path_indices(batch + first, count, n, moves);
+                evaluate_path_lanes(moves, n, S0, factors, lanes);
+
+                for (int l = 0; l < count; ++l) {
+                    double S_min = lanes.S_min[l];
+                    double S_max = lanes.S_max[l];
+                    double G = lanes.G[l];
+
+                    if (seasoned) {
+                        S_min = std::min(S_min, seasoning.min);
+                        S_max = std::max(S_max, seasoning.max);
+                        G = std::exp((seasoning.log_sum + (n + 1) * std::log(G)) / N);
+                    }
+
+                    double rho_omega = compute_path_rho(S_min, S_max);
+                    sum_path_specific += lanes.prob[l] * (rho_omega - 1.0) * G;
                 }
-
-                double path_prob = std::pow(factors.p_adj, n_ups) *
-                                  std::pow(1.0 - factors.p_adj, n - n_ups);
-
-                sum_path_specific += path_prob * (rho_omega - 1.0) * G;
             }
 
             double scaling = (double)total_paths / (double)n_paths_sampled;
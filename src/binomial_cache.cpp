@@ -0,0 +1,124 @@
+#include <Rcpp.h>
+#include "binomial_cache.h"
+#include <atomic>
+#include <cmath>
+#include <math.h>
+#include <mutex>
+
+// Exact binomial coefficients for n <= PASCAL_MAX_N, built on first use
+struct PascalTable {
+    double rows[PASCAL_MAX_N + 1][PASCAL_MAX_N + 1];
+
+    PascalTable() {
+        for (int n = 0; n <= PASCAL_MAX_N; ++n) {
+            rows[n][0] = 1.0;
+            rows[n][n] = 1.0;
+            for (int k = 1; k < n; ++k) {
+                rows[n][k] = rows[n - 1][k - 1] + rows[n - 1][k];
+            }
+            for (int k = n + 1; k <= PASCAL_MAX_N; ++k) {
+                rows[n][k] = 0.0;
+            }
+        }
+    }
+};
+
+// log Gamma(x) for x > 0. lgamma stores the sign in the global signgam, a
+// data race when pricing threads reach here together; the reentrant
+// lgamma_r returns it instead, and where it is missing the calls are
+// serialized.
+#if defined(_WIN32)
+static std::mutex log_gamma_mutex;
+#endif
+
+static double log_gamma(double x) {
+#if defined(_WIN32)
+    std::lock_guard<std::mutex> lock(log_gamma_mutex);
+    return std::lgamma(x);
+#else
+    int sign;
+    return lgamma_r(x, &sign);
+#endif
+}
+
+static const PascalTable& pascal_table() {
+    static const PascalTable table;
+    return table;
+}
+
+// Log-factorials are stored in fixed-size chunks that never move once
+// filled, so readers index them without locking. Writers fill whole chunks
+// under the mutex and then publish the new length with release semantics;
+// a reader that sees the length also sees the chunk.
+static const int CHUNK_BITS = 16;
+static const size_t CHUNK_SIZE = (size_t)1 << CHUNK_BITS;
+static const size_t MAX_CHUNKS = 256;
+
+static double* log_factorial_chunks[MAX_CHUNKS];
+static std::atomic<size_t> log_factorial_cached(0);
+static std::mutex log_factorial_mutex;
+
+static void grow_log_factorials(size_t n) {
+    std::lock_guard<std::mutex> lock(log_factorial_mutex);
+
+    size_t cached = log_factorial_cached.load(std::memory_order_relaxed);
+    while (cached <= n) {
+        size_t chunk = cached >> CHUNK_BITS;
+        double* values = new double[CHUNK_SIZE];
+        for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+            values[i] = log_gamma((double)(cached + i) + 1.0);
+        }
+        log_factorial_chunks[chunk] = values;
+        cached += CHUNK_SIZE;
+        log_factorial_cached.store(cached, std::memory_order_release);
+    }
+}
+
+double log_factorial(int n) {
+    if (n < 0) {
+        return R_NaN;
+    }
+
+    size_t i = n;
+    if (i >= MAX_CHUNKS * CHUNK_SIZE) {
+        return log_gamma(n + 1.0);
+    }
+    if (i >= log_factorial_cached.load(std::memory_order_acquire)) {
+        grow_log_factorials(i);
+    }
+
+    return log_factorial_chunks[i >> CHUNK_BITS][i & (CHUNK_SIZE - 1)];
+}
+
+double log_binomial_coefficient(int n, int k) {
+    if (k < 0 || k > n) {
+        return R_NegInf;
+    }
+    if (n <= PASCAL_MAX_N) {
+        return std::log(pascal_table().rows[n][k]);
+    }
+
+    return log_factorial(n) - log_factorial(k) - log_factorial(n - k);
+}
+
+double log_binomial_weight(int n, int k, double log_p, double log_q) {
+    double value = log_binomial_coefficient(n, k);
+    if (k > 0) {
+        value += k * log_p;
+    }
+    if (n - k > 0) {
+        value += (n - k) * log_q;
+    }
+    return value;
+}
+
+double binomial_coefficient(int n, int k) {
+    if (k < 0 || k > n) {
+        return 0.0;
+    }
+    if (n <= PASCAL_MAX_N) {
+        return pascal_table().rows[n][k];
+    }
+
+    return std::exp(log_binomial_coefficient(n, k));
+}
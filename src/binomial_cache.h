@@ -0,0 +1,22 @@
+#ifndef BINOMIAL_CACHE_H
+#define BINOMIAL_CACHE_H
+
+// Largest n whose Pascal row is exact in double: C(57, 28) exceeds 2^53
+const int PASCAL_MAX_N = 56;
+
+// C(n, k), exact from a Pascal table for n <= PASCAL_MAX_N. Overflows to
+// Inf past n of about 1030; use the log forms for large trees.
+double binomial_coefficient(int n, int k);
+
+// log(n!) from a table shared by all threads. The table grows on demand in
+// chunks up to 2^24 entries; beyond that lgamma_r is evaluated directly.
+double log_factorial(int n);
+
+// log C(n, k); -Inf outside 0 <= k <= n
+double log_binomial_coefficient(int n, int k);
+
+// log of the binomial probability C(n, k) p^k q^(n-k) given log p and
+// log q. A zero exponent contributes nothing, so p = 0 or q = 0 is safe.
+double log_binomial_weight(int n, int k, double log_p, double log_q);
+
+#endif
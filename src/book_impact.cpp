@@ -0,0 +1,419 @@
+#include <Rcpp.h>
+#include "utils.h"
+#include "geometric_distribution.h"
+#include "scratch_arena.h"
+#include <vector>
+#include <map>
+#include <exception>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Value tables shared by the options of one maturity n on the current
+// lattice: full prices the option at step 0 and residual[t] at step t + 1
+// (n - t - 1 steps left, S_0..S_t realized) for t < n - 1
+struct BookMaturity {
+    int n;
+    GeometricDistribution full;
+    std::vector<GeometricDistribution> residual;
+    std::vector<double> discount;  // discount[t] = r^-(n - t - 1), t = -1..n - 2
+};
+
+struct BookOption {
+    int maturity;  // index into the maturities
+    double K;
+    bool is_call;
+};
+
+// Lattice geometry shared by every option in one iteration
+struct BookLattice {
+    double log_S0;
+    double log_u;
+    double log_d;
+    double spread;  // u_tilde - d_tilde
+    double p;
+};
+
+// One option's sweep of the lattice: its price and delta at step 0, and the
+// expected change of its delta over an up and over a down move, summed over
+// the steps at which it is rebalanced
+struct OptionImpact {
+    double price;
+    double delta;
+    double up;
+    double down;
+};
+
+static void build_book_maturity(BookMaturity& maturity,
+                                const AdjustedFactors& factors, double r) {
+    int n = maturity.n;
+    maturity.full = build_geometric_distribution(n, factors);
+    maturity.residual.clear();
+    maturity.discount.assign(1, std::pow(r, -n));
+
+    if (n > 1) {
+        GeometricDistribution dist = build_geometric_distribution(n - 1, factors, 1);
+        for (int t = 0; t < n - 1; ++t) {
+            if (t > 0) {
+                roll_geometric_distribution(dist, factors);
+            }
+            maturity.residual.push_back(dist);
+            maturity.discount.push_back(std::pow(r, -(n - t - 1)));
+        }
+    }
+}
+
+// Value at step t + 1 with spot S, where log_sum covers S_0..S_t
+static double value_after_step(
+    const BookMaturity& maturity, const BookOption& option, int t,
+    double S, double log_sum
+) {
+    double N = maturity.n + 1;
+    if (t == maturity.n - 1) {
+        double G = std::exp((log_sum + std::log(S)) / N);
+        return option.is_call ? std::max(0.0, G - option.K)
+                              : std::max(0.0, option.K - G);
+    }
+    return quote_geometric(maturity.residual[t], S, option.K, std::exp(log_sum / N),
+                           option.is_call, maturity.discount[t + 1]).price;
+}
+
+// Replicating delta at step t in the state with k ups and weighted up-count
+// W = sum_j (t - j + 1) X_j, which fix S_t and the log-sum of S_0..S_t
+static double lattice_delta(
+    const BookMaturity& maturity, const BookOption& option,
+    const BookLattice& lattice, int t, int k, long long W
+) {
+    double log_S = lattice.log_S0 + k * lattice.log_u + (t - k) * lattice.log_d;
+    double log_sum = (t + 1) * lattice.log_S0 + W * lattice.log_u +
+                     ((double)t * (t + 1) / 2 - W) * lattice.log_d;
+    double S = std::exp(log_S);
+    double value_up = value_after_step(maturity, option, t,
+                                       std::exp(log_S + lattice.log_u), log_sum);
+    double value_down = value_after_step(maturity, option, t,
+                                         std::exp(log_S + lattice.log_d), log_sum);
+    return (value_up - value_down) / (S * lattice.spread);
+}
+
+// Row k of a sweep layer holds the W reachable with k ups by step n - 1,
+// k(k+1)/2..k(n-1) - k(k-1)/2, which covers every earlier step's range.
+// Rows are stored back to back, so a layer has about n^3 / 6 entries.
+static size_t sweep_row_offset(int n, int k) {
+    // sum_{j<k} (j (n - 1 - j) + 1)
+    long long m = n - 1;
+    long long kk = k;
+    return (size_t)(m * kk * (kk - 1) / 2 - (kk - 1) * kk * (2 * kk - 1) / 6 + kk);
+}
+
+static size_t sweep_layer_size(int n) {
+    return sweep_row_offset(n, n);
+}
+
+// The four layers of one sweep, allocated by the caller for the longest
+// maturity so that no memory is obtained inside the parallel region
+struct SweepWorkspace {
+    double* prob;
+    double* next_prob;
+    double* delta;
+    double* next_delta;
+};
+
+// Sweeps the reachable states (k, W) of steps 0..n - 1 forward, carrying
+// their probabilities and the option's delta. The state (k, W) at step t
+// moves to (k + 1, W + k + 1) on an up move and to (k, W + k) on a down
+// move, and has W between k(k+1)/2 and k t - k(k-1)/2. Entries are
+// indexed by W - k(k+1)/2 within their row, so the up move keeps the
+// index and the down move adds k.
+static OptionImpact sweep_option(
+    const BookMaturity& maturity, const BookOption& option,
+    const BookLattice& lattice, double S0, SweepWorkspace work
+) {
+    int n = maturity.n;
+
+    OptionImpact impact;
+    impact.price = quote_geometric(maturity.full, S0, option.K, 1.0, option.is_call,
+                                   maturity.discount[0]).price;
+    impact.delta = lattice_delta(maturity, option, lattice, 0, 0, 0);
+    impact.up = 0.0;
+    impact.down = 0.0;
+
+    double* prob = work.prob;
+    double* next_prob = work.next_prob;
+    double* delta = work.delta;
+    double* next_delta = work.next_delta;
+
+    prob[0] = 1.0;
+    delta[0] = impact.delta;
+
+    for (int t = 0; t < n - 1; ++t) {
+        int s = t + 1;
+        for (int k = 0; k <= s; ++k) {
+            size_t row = sweep_row_offset(n, k);
+            long long lo = (long long)k * (k + 1) / 2;
+            long long width = (long long)k * (s - k) + 1;
+            for (long long i = 0; i < width; ++i) {
+                next_prob[row + i] = 0.0;
+                next_delta[row + i] = lattice_delta(maturity, option,
+                                                    lattice, s, k, lo + i);
+            }
+        }
+
+        for (int k = 0; k <= t; ++k) {
+            size_t row = sweep_row_offset(n, k);
+            size_t row_up = sweep_row_offset(n, k + 1);
+            long long width = (long long)k * (t - k) + 1;
+            for (long long i = 0; i < width; ++i) {
+                double P = prob[row + i];
+                double here = delta[row + i];
+                size_t up = row_up + i;
+                size_t down = row + i + k;
+                impact.up += P * (next_delta[up] - here);
+                impact.down += P * (next_delta[down] - here);
+                next_prob[up] += lattice.p * P;
+                next_prob[down] += (1.0 - lattice.p) * P;
+            }
+        }
+
+        std::swap(prob, next_prob);
+        std::swap(delta, next_delta);
+    }
+
+    return impact;
+}
+
+//' Price a Book of Geometric Asian Options with Impact from Its Net Hedge
+//'
+//' Prices the options on one underlying jointly on a shared impacted
+//' lattice whose hedging volumes are those of the book's aggregate delta,
+//' iterating until the volumes and the prices are consistent.
+//'
+//' @param S0 Initial stock price (positive)
+//' @param K Strike of each option (positive)
+//' @param n Time steps of each option (positive integers)
+//' @param option_type "call" or "put" for each option
+//' @param notional Number of each option sold (negative for options bought)
+//' @param r Gross risk-free rate per period
+//' @param u Base up factor in CRR model
+//' @param d Base down factor in CRR model
+//' @param lambda Price impact coefficient (non-negative)
+//' @param v_u Starting hedging volume on up move (default: 0)
+//' @param v_d Starting hedging volume on down move (default: 0)
+//' @param damping Weight of the new volumes in each update, in (0, 1]
+//' @param tol Convergence tolerance on the volumes
+//' @param max_iter Maximum number of iterations
+//' @param n_threads Threads over the options in each iteration
+//'
+//' @return List with the option \code{price} and \code{delta} at step 0,
+//'   the volumes \code{v_u} and \code{v_d} the prices were computed with,
+//'   the volumes \code{implied_v_u} and \code{implied_v_d} the book's hedge
+//'   generates on that lattice, the lattice \code{u_tilde}, \code{d_tilde}
+//'   and \code{p_adj}, the number of \code{iterations}, whether the
+//'   iteration \code{converged}, and the volume \code{history}
+//'
+//' @details
+//' The book holds \eqn{D_t = \sum_i notional_i \Delta^i_t} shares, with
+//' \eqn{\Delta^i_t} the replicating delta of option \eqn{i} in the state of
+//' step \eqn{t}; an option is rebalanced at steps \eqn{1..n_i - 1} and
+//' settled at its maturity. Given volumes \eqn{(v_u, v_d)}, every option is
+//' valued on the lattice with \eqn{\tilde{u} = u e^{\lambda v_u}},
+//' \eqn{\tilde{d} = d e^{-\lambda v_d}}, and the implied volumes are the
+//' book's expected net trade per step, bought into up moves and sold into
+//' down moves:
+//' \eqn{v_u = E^Q[D_{t+1} - D_t | up]} and
+//' \eqn{v_d = E^Q[D_t - D_{t+1} | down]}, averaged over the steps up to
+//' the last rebalancing. Offsetting positions net out, so the volumes may be
+//' negative. The update repeats until the volumes move by less than
+//' \code{tol}.
+//'
+//' A state of step \eqn{t} is its up-count \eqn{k} and weighted up-count
+//' \eqn{W}, which fix \eqn{S_t} and the log-sum of \eqn{S_0..S_t}; the
+//' option values after each move are quoted from the rolled distribution of
+//' the residual geometric average. An option of \eqn{n} steps costs
+//' \eqn{O(n^4)} quotes per iteration, and the options are swept in parallel,
+//' each thread with four layers of about \eqn{n^3 / 6} doubles for the
+//' longest maturity, allocated before the parallel region.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List price_book_impact_cpp(
+    double S0, Rcpp::NumericVector K, Rcpp::IntegerVector n,
+    std::vector<std::string> option_type, Rcpp::NumericVector notional,
+    double r, double u, double d, double lambda,
+    double v_u = 0.0, double v_d = 0.0,
+    double damping = 1.0, double tol = 1e-10, int max_iter = 100,
+    int n_threads = 1
+) {
+    int n_options = K.size();
+
+    if (n_options < 1) {
+        Rcpp::stop("the book must hold at least one option");
+    }
+    if ((int)n.size() != n_options || (int)option_type.size() != n_options ||
+        (int)notional.size() != n_options) {
+        Rcpp::stop("K, n, option_type and notional must have the same length");
+    }
+    if (!(damping > 0.0 && damping <= 1.0)) {
+        Rcpp::stop("damping must be in (0, 1]");
+    }
+    if (!(tol > 0.0)) {
+        Rcpp::stop("tol must be positive");
+    }
+    if (max_iter < 1) {
+        Rcpp::stop("max_iter must be a positive integer");
+    }
+    if (n_threads < 1) {
+        Rcpp::stop("n_threads must be a positive integer");
+    }
+
+    std::vector<BookMaturity> maturities;
+    std::vector<BookOption> options(n_options);
+    std::map<int, int> maturity_index;
+    int last_step = 0;
+
+    for (int i = 0; i < n_options; ++i) {
+        if (option_type[i] != "call" && option_type[i] != "put") {
+            Rcpp::stop("option_type must be either 'call' or 'put'");
+        }
+        if (n[i] <= 0) {
+            Rcpp::stop("n must be a positive integer");
+        }
+
+        std::map<int, int>::iterator it = maturity_index.find(n[i]);
+        if (it == maturity_index.end()) {
+            BookMaturity maturity;
+            maturity.n = n[i];
+            maturity_index[n[i]] = maturities.size();
+            options[i].maturity = maturities.size();
+            maturities.push_back(maturity);
+        } else {
+            options[i].maturity = it->second;
+        }
+        options[i].K = K[i];
+        options[i].is_call = (option_type[i] == "call");
+        last_step = std::max(last_step, (int)n[i]);
+    }
+
+    // Steps at which some option is rebalanced
+    int rebalance_steps = std::max(1, last_step - 1);
+    int n_maturities = maturities.size();
+
+    // One sweep workspace per thread, sized for the longest maturity. A
+    // failed allocation here is an ordinary R error; inside the parallel
+    // region it would terminate the session.
+    int n_workers = 1;
+#ifdef _OPENMP
+    n_workers = std::min(n_threads, n_options);
+#endif
+    size_t layer = sweep_layer_size(last_step);
+    ScratchFrame frame;
+    std::vector<SweepWorkspace> workspaces(n_workers);
+    for (int w = 0; w < n_workers; ++w) {
+        workspaces[w].prob = frame.allocate<double>(layer);
+        workspaces[w].next_prob = frame.allocate<double>(layer);
+        workspaces[w].delta = frame.allocate<double>(layer);
+        workspaces[w].next_delta = frame.allocate<double>(layer);
+    }
+
+    std::vector<OptionImpact> impacts(n_options);
+    std::vector<double> history_u, history_d;
+    AdjustedFactors factors;
+    double implied_u = v_u;
+    double implied_d = v_d;
+    bool converged = false;
+    int iteration = 0;
+
+    while (iteration < max_iter && !converged) {
+        ++iteration;
+
+        double u_tilde = u * std::exp(lambda * v_u);
+        double d_tilde = d * std::exp(-lambda * v_d);
+        if (!(d_tilde < r && r < u_tilde)) {
+            Rcpp::stop("No-arbitrage condition violated at iteration " +
+                       std::to_string(iteration) +
+                       ": the book's hedging volumes give d_tilde >= r or r >= u_tilde");
+        }
+        factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+
+        BookLattice lattice;
+        lattice.log_S0 = std::log(S0);
+        lattice.log_u = std::log(factors.u_tilde);
+        lattice.log_d = std::log(factors.d_tilde);
+        lattice.spread = factors.u_tilde - factors.d_tilde;
+        lattice.p = factors.p_adj;
+
+        // The distributions are allocated as they are built, so failures are
+        // caught in the region and raised after it
+        std::string failure;
+        #pragma omp parallel for num_threads(n_threads) schedule(static)
+        for (int j = 0; j < n_maturities; ++j) {
+            try {
+                build_book_maturity(maturities[j], factors, r);
+            } catch (std::exception& e) {
+                #pragma omp critical
+                if (failure.empty()) {
+                    failure = e.what();
+                }
+            }
+        }
+        if (!failure.empty()) {
+            Rcpp::stop("building the value tables failed: " + failure);
+        }
+
+        #pragma omp parallel for num_threads(n_workers) schedule(static)
+        for (int i = 0; i < n_options; ++i) {
+            int w = 0;
+#ifdef _OPENMP
+            w = omp_get_thread_num();
+#endif
+            impacts[i] = sweep_option(maturities[options[i].maturity], options[i],
+                                      lattice, S0, workspaces[w]);
+        }
+
+        // Summed in book order, so the result does not depend on the threads
+        double trade_up = 0.0;
+        double trade_down = 0.0;
+        for (int i = 0; i < n_options; ++i) {
+            trade_up += notional[i] * impacts[i].up;
+            trade_down += notional[i] * impacts[i].down;
+        }
+        implied_u = trade_up / rebalance_steps;
+        implied_d = -trade_down / rebalance_steps;
+
+        history_u.push_back(v_u);
+        history_d.push_back(v_d);
+
+        if (std::max(std::fabs(implied_u - v_u), std::fabs(implied_d - v_d)) < tol) {
+            converged = true;
+        } else if (iteration < max_iter) {
+            v_u += damping * (implied_u - v_u);
+            v_d += damping * (implied_d - v_d);
+        }
+    }
+
+    Rcpp::NumericVector price(n_options), delta(n_options);
+    for (int i = 0; i < n_options; ++i) {
+        price[i] = impacts[i].price;
+        delta[i] = impacts[i].delta;
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("price") = price,
+        Rcpp::Named("delta") = delta,
+        Rcpp::Named("v_u") = v_u,
+        Rcpp::Named("v_d") = v_d,
+        Rcpp::Named("implied_v_u") = implied_u,
+        Rcpp::Named("implied_v_d") = implied_d,
+        Rcpp::Named("u_tilde") = factors.u_tilde,
+        Rcpp::Named("d_tilde") = factors.d_tilde,
+        Rcpp::Named("p_adj") = factors.p_adj,
+        Rcpp::Named("iterations") = iteration,
+        Rcpp::Named("converged") = converged,
+        Rcpp::Named("history") = Rcpp::List::create(
+            Rcpp::Named("v_u") = Rcpp::NumericVector(history_u.begin(), history_u.end()),
+            Rcpp::Named("v_d") = Rcpp::NumericVector(history_d.begin(), history_d.end()))
+    );
+}
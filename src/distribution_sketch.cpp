@@ -0,0 +1,118 @@
+#include "distribution_sketch.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+DistributionSketch::DistributionSketch(double accuracy)
+    : accuracy_(accuracy),
+      log_gamma_(std::log((1.0 + accuracy) / (1.0 - accuracy))),
+      total_(0.0), weighted_sum_(0.0), zero_weight_(0.0),
+      min_(std::numeric_limits<double>::infinity()),
+      max_(-std::numeric_limits<double>::infinity()),
+      first_(0) {
+    if (!(accuracy > 0.0 && accuracy < 1.0)) {
+        Rcpp::stop("accuracy must be in (0, 1)");
+    }
+}
+
+void DistributionSketch::add(double x, double weight) {
+    if (weight <= 0.0) {
+        return;
+    }
+
+    total_ += weight;
+    weighted_sum_ += weight * x;
+    min_ = std::min(min_, x);
+    max_ = std::max(max_, x);
+
+    if (!(x > 0.0)) {
+        zero_weight_ += weight;
+        return;
+    }
+
+    int bin = (int)std::ceil(std::log(x) / log_gamma_);
+
+    if (weights_.empty()) {
+        first_ = bin;
+        weights_.assign(1, 0.0);
+    } else if (bin < first_) {
+        // Grow downwards by at least the current size so that a slowly
+        // falling sequence costs amortized O(1) per value
+        int grow = std::max(first_ - bin, (int)weights_.size());
+        weights_.insert(weights_.begin(), grow, 0.0);
+        first_ -= grow;
+    } else if (bin >= first_ + (int)weights_.size()) {
+        weights_.resize(bin - first_ + 1, 0.0);
+    }
+
+    weights_[bin - first_] += weight;
+}
+
+double DistributionSketch::quantile(double prob) const {
+    if (total_ <= 0.0) {
+        return R_NaN;
+    }
+    if (prob <= 0.0) {
+        return min_;
+    }
+    if (prob >= 1.0) {
+        return max_;
+    }
+
+    double rank = prob * total_;
+    double cumulative = zero_weight_;
+    if (cumulative >= rank) {
+        return min_;
+    }
+
+    double gamma = std::exp(log_gamma_);
+    for (size_t i = 0; i < weights_.size(); ++i) {
+        cumulative += weights_[i];
+        if (cumulative >= rank) {
+            // The point of the bin within a factor 1 +- accuracy of both ends
+            double value = 2.0 * std::exp((first_ + (int)i) * log_gamma_) / (gamma + 1.0);
+            return std::min(max_, std::max(min_, value));
+        }
+    }
+
+    return max_;
+}
+
+Rcpp::List DistributionSketch::summary(const Rcpp::NumericVector& probs) const {
+    // Trim the bins left empty by downward growth
+    size_t lo = 0;
+    size_t hi = weights_.size();
+    while (lo < hi && weights_[lo] == 0.0) {
+        ++lo;
+    }
+    while (hi > lo && weights_[hi - 1] == 0.0) {
+        --hi;
+    }
+
+    Rcpp::NumericVector breaks(hi > lo ? hi - lo + 1 : 0);
+    Rcpp::NumericVector mass(hi - lo);
+    for (size_t i = lo; i < hi; ++i) {
+        breaks[i - lo] = std::exp((first_ + (int)i - 1) * log_gamma_);
+        mass[i - lo] = weights_[i] / total_;
+    }
+    if (hi > lo) {
+        breaks[hi - lo] = std::exp((first_ + (int)hi - 1) * log_gamma_);
+    }
+
+    int count = probs.size();
+    Rcpp::NumericVector quantiles(count);
+    for (int i = 0; i < count; ++i) {
+        quantiles[i] = quantile(probs[i]);
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("mean") = mean(),
+        Rcpp::Named("min") = total_ > 0.0 ? min_ : R_NaN,
+        Rcpp::Named("max") = total_ > 0.0 ? max_ : R_NaN,
+        Rcpp::Named("zero_mass") = total_ > 0.0 ? zero_weight_ / total_ : R_NaN,
+        Rcpp::Named("breaks") = breaks,
+        Rcpp::Named("mass") = mass,
+        Rcpp::Named("probs") = probs,
+        Rcpp::Named("quantiles") = quantiles
+    );
+}
@@ -0,0 +1,44 @@
+#ifndef DISTRIBUTION_SKETCH_H
+#define DISTRIBUTION_SKETCH_H
+
+#include <Rcpp.h>
+#include <vector>
+
+// Weighted one-pass summary of a non-negative quantity (a payoff or an
+// average) that the engines fill alongside their expectations. Positive
+// values fall into fixed logarithmic bins (gamma^(i-1), gamma^i] with
+// gamma = (1 + accuracy) / (1 - accuracy); zeros, which carry the whole
+// out-of-the-money mass of a payoff, are counted apart. The bins are the
+// histogram and also give every quantile to within a relative error of
+// `accuracy`, with no range fixed in advance. Adding a value costs one log.
+class DistributionSketch {
+public:
+    explicit DistributionSketch(double accuracy);
+
+    void add(double x, double weight);
+
+    double total() const { return total_; }
+    double mean() const { return total_ > 0.0 ? weighted_sum_ / total_ : R_NaN; }
+
+    // Smallest x with P(X <= x) >= prob, to relative accuracy; exact at the
+    // extremes and at 0
+    double quantile(double prob) const;
+
+    // List with mean, min, max, zero_mass, the occupied bins as breaks
+    // (one more than bins) and their probabilities mass, and the quantiles
+    // at probs
+    Rcpp::List summary(const Rcpp::NumericVector& probs) const;
+
+private:
+    double accuracy_;
+    double log_gamma_;
+    double total_;
+    double weighted_sum_;
+    double zero_weight_;
+    double min_;
+    double max_;
+    int first_;                   // bin index of weights_[0]
+    std::vector<double> weights_;
+};
+
+#endif
@@ -1,8 +1,41 @@
 #include <Rcpp.h>
 #include "utils.h"
+#include "binomial_cache.h"
+#include "path_kernel.h"
+#include "scratch_arena.h"
 #include <cmath>
 #include <algorithm>
 
+// Discounted expected payoff over the n + 1 terminal nodes. Each weight
+// C(n, k) p^k q^(n-k) / r^n is formed in log space, so large trees neither
+// overflow the coefficient nor underflow the powers before they combine.
+static double sum_european_payoffs(
+    double S0, double K, double r, const AdjustedFactors& factors, int n,
+    bool is_call
+) {
+    double log_p = std::log(factors.p_adj);
+    double log_q = std::log(1.0 - factors.p_adj);
+    double log_u = std::log(factors.u_tilde);
+    double log_d = std::log(factors.d_tilde);
+    double log_discount = -n * std::log(r);
+
+    double option_value = 0.0;
+
+    for (int k = 0; k <= n; ++k) {
+        double S_n = S0 * std::exp(k * log_u + (n - k) * log_d);
+
+        double payoff = is_call ? std::max(0.0, S_n - K) : std::max(0.0, K - S_n);
+        if (payoff == 0.0) {
+            continue;
+        }
+
+        option_value += std::exp(log_binomial_weight(n, k, log_p, log_q) +
+                                 log_discount) * payoff;
+    }
+
+    return option_value;
+}
+
 //' Price European Call Option with Price Impact
 //'
 //' Computes the exact price of a European call option using the
@@ -57,25 +90,7 @@ double price_european_call_cpp(
 ) {
     AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
 
-    double discount = std::pow(r, -n);
-
-    double option_value = 0.0;
-
-    for (int k = 0; k <= n; ++k) {
-        double S_n = S0 * std::pow(factors.u_tilde, k) * std::pow(factors.d_tilde, n - k);
-
-        double payoff = std::max(0.0, S_n - K);
-
-        double binom_coeff = binomial_coefficient(n, k);
-        double prob = binom_coeff * std::pow(factors.p_adj, k) *
-                     std::pow(1.0 - factors.p_adj, n - k);
-
-        option_value += prob * payoff;
-    }
-
-    option_value *= discount;
-
-    return option_value;
+    return sum_european_payoffs(S0, K, r, factors, n, true);
 }
 
 //' Price European Put Option with Price Impact
@@ -129,23 +144,141 @@ double price_european_put_cpp(
 ) {
     AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
 
-    double discount = std::pow(r, -n);
+    return sum_european_payoffs(S0, K, r, factors, n, false);
+}
 
-    double option_value = 0.0;
+// The lane recurrences start from S0 d^n and (q / r)^n and end at S0 u^n,
+// so every one of these must stay a normal double
+static bool fits_european_lanes(
+    double S0, double r, const AdjustedFactors& factors, int n
+) {
+    const double LIMIT = 700.0;
+    double log_weight = n * (std::log(1.0 - factors.p_adj) - std::log(r));
+    double log_low = std::log(S0) + n * std::log(factors.d_tilde);
+    double log_high = std::log(S0) + n * std::log(factors.u_tilde);
 
-    for (int k = 0; k <= n; ++k) {
-        double S_n = S0 * std::pow(factors.u_tilde, k) * std::pow(factors.d_tilde, n - k);
+    return log_weight > -LIMIT && std::fabs(log_low) < LIMIT &&
+           std::fabs(log_high) < LIMIT;
+}
 
-        double payoff = std::max(0.0, K - S_n);
+//' Price a Batch of European Options with Price Impact
+//'
+//' Prices many European options in one call. Options are grouped by number
+//' of steps and evaluated \code{PATH_LANES} at a time, one option per SIMD
+//' lane.
+//'
+//' @param S0 Initial stock price of each option
+//' @param K Strike price of each option
+//' @param r Gross risk-free rate per period of each option
+//' @param u Base up factor of each option
+//' @param d Base down factor of each option
+//' @param lambda Price impact coefficient of each option
+//' @param v_u Hedging volume on up move of each option
+//' @param v_d Hedging volume on down move of each option
+//' @param n Number of time steps of each option
+//' @param option_type "call" or "put" for each option
+//'
+//' @return Numeric vector of prices, in input order
+//'
+//' @details
+//' The inputs are laid out as structure-of-arrays in lane groups of similar
+//' \eqn{n}. Within a group, terminal prices and binomial weights advance by
+//' one multiplication per node,
+//' \eqn{S_{k+1} = S_k \tilde{u}/\tilde{d}} and
+//' \eqn{w_{k+1} = w_k \frac{n-k}{k+1} \frac{p}{1-p}}, and shorter trees are
+//' padded to the group's largest \eqn{n}. Options whose extreme terminal
+//' prices or \eqn{(1-p)^n/r^n} leave the normal double range fall back to
+//' the log-space scalar sum of \code{\link{price_european_call_cpp}}.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::NumericVector price_european_batch_cpp(
+    Rcpp::NumericVector S0, Rcpp::NumericVector K, Rcpp::NumericVector r,
+    Rcpp::NumericVector u, Rcpp::NumericVector d,
+    Rcpp::NumericVector lambda, Rcpp::NumericVector v_u,
+    Rcpp::NumericVector v_d, Rcpp::IntegerVector n,
+    std::vector<std::string> option_type
+) {
+    int n_options = S0.size();
+
+    if ((int)K.size() != n_options || (int)r.size() != n_options ||
+        (int)u.size() != n_options || (int)d.size() != n_options ||
+        (int)lambda.size() != n_options || (int)v_u.size() != n_options ||
+        (int)v_d.size() != n_options || (int)n.size() != n_options ||
+        (int)option_type.size() != n_options) {
+        Rcpp::stop("All inputs must have the same length");
+    }
 
-        double binom_coeff = binomial_coefficient(n, k);
-        double prob = binom_coeff * std::pow(factors.p_adj, k) *
-                     std::pow(1.0 - factors.p_adj, n - k);
+    Rcpp::NumericVector prices(n_options);
 
-        option_value += prob * payoff;
+    ScratchFrame frame;
+    AdjustedFactors* factors = frame.allocate<AdjustedFactors>(n_options);
+    int* order = frame.allocate<int>(n_options);
+    int n_lanes = 0;
+
+    for (int i = 0; i < n_options; ++i) {
+        if (option_type[i] != "call" && option_type[i] != "put") {
+            Rcpp::stop("option_type must be either 'call' or 'put'");
+        }
+        if (n[i] <= 0) {
+            Rcpp::stop("n must be a positive integer");
+        }
+
+        factors[i] = compute_adjusted_factors(r[i], u[i], d[i],
+                                              lambda[i], v_u[i], v_d[i]);
+
+        if (fits_european_lanes(S0[i], r[i], factors[i], n[i])) {
+            order[n_lanes++] = i;
+        } else {
+            prices[i] = sum_european_payoffs(S0[i], K[i], r[i], factors[i], n[i],
+                                             option_type[i] == "call");
+        }
     }
 
-    option_value *= discount;
+    // Neighbours in n share a lane group, which keeps the padding small
+    std::stable_sort(order, order + n_lanes, [&](int a, int b) {
+        return n[a] < n[b];
+    });
 
-    return option_value;
+    EuropeanLanes lanes;
+    double value[PATH_LANES];
+
+    for (int first = 0; first < n_lanes; first += PATH_LANES) {
+        int count = std::min(PATH_LANES, n_lanes - first);
+        int n_max = 0;
+
+        for (int l = 0; l < PATH_LANES; ++l) {
+            if (l >= count) {
+                lanes.S_start[l] = 0.0;
+                lanes.ratio[l] = 1.0;
+                lanes.weight[l] = 0.0;
+                lanes.odds[l] = 0.0;
+                lanes.n[l] = -1.0;
+                lanes.K[l] = 0.0;
+                lanes.sign[l] = 1.0;
+                continue;
+            }
+
+            int i = order[first + l];
+            const AdjustedFactors& f = factors[i];
+            double q = 1.0 - f.p_adj;
+
+            lanes.S_start[l] = S0[i] * std::pow(f.d_tilde, n[i]);
+            lanes.ratio[l] = f.u_tilde / f.d_tilde;
+            lanes.weight[l] = std::pow(q / r[i], n[i]);
+            lanes.odds[l] = f.p_adj / q;
+            lanes.n[l] = n[i];
+            lanes.K[l] = K[i];
+            lanes.sign[l] = (option_type[i] == "call") ? 1.0 : -1.0;
+            n_max = std::max(n_max, (int)n[i]);
+        }
+
+        evaluate_european_lanes(lanes, n_max, value);
+
+        for (int l = 0; l < count; ++l) {
+            prices[order[first + l]] = value[l];
+        }
+    }
+
+    return prices;
 }
@@ -1,35 +1,9 @@
 #include <Rcpp.h>
 #include "utils.h"
+#include "path_enumeration.h"
 #include <vector>
 #include <cmath>
-
-// Helper function to generate all binary paths of length n
-void generate_all_paths_recursive(
-    int n,
-    int current_step,
-    std::vector<int>& current_path,
-    std::vector<std::vector<int>>& all_paths
-) {
-    if (current_step == n) {
-        all_paths.push_back(current_path);
-        return;
-    }
-
-    current_path[current_step] = 1;
-    generate_all_paths_recursive(n, current_step + 1, current_path, all_paths);
-
-    current_path[current_step] = 0;
-    generate_all_paths_recursive(n, current_step + 1, current_path, all_paths);
-}
-
-std::vector<std::vector<int>> generate_all_paths(int n) {
-    std::vector<std::vector<int>> all_paths;
-    std::vector<int> current_path(n);
-
-    generate_all_paths_recursive(n, 0, current_path, all_paths);
-
-    return all_paths;
-}
+#include <algorithm>
 
 //' Price Geometric Asian Option with Price Impact
 //'
@@ -46,6 +20,10 @@ std::vector<std::vector<int>> generate_all_paths(int n) {
 //' @param v_d Hedging volume on down move (non-negative)
 //' @param n Number of time steps (positive integer)
 //' @param option_type Type of option: "call" or "put" (default: "call")
+//' @param n_fixed Number of fixings already realized before \code{S0}
+//'   (default: 0)
+//' @param fixed_sum Sum of the realized fixings (default: 0)
+//' @param fixed_log_sum Sum of the logs of the realized fixings (default: 0)
 //'
 //' @return Geometric Asian option price
 //'
@@ -64,6 +42,11 @@ std::vector<std::vector<int>> generate_all_paths(int n) {
 //'   \item Adjusted down factor: \eqn{d_{tilde} = d \cdot \exp(-\lambda \cdot v_d)}
 //' }
 //'
+//' For a seasoned option with \eqn{k} = \code{n_fixed} realized fixings
+//' \eqn{F_1, \ldots, F_k}, only the residual tree from \code{S0} is
+//' enumerated and the average becomes
+//' \eqn{G = (F_1 \cdots F_k \cdot S_0 \cdots S_n)^{1/(k+n+1)}}.
+//'
 //' @references
 //' Cox, J. C., Ross, S. A., & Rubinstein, M. (1979). Option pricing:
 //' A simplified approach. Journal of Financial Economics, 7(3), 229-263.
@@ -88,46 +71,24 @@ std::vector<std::vector<int>> generate_all_paths(int n) {
 double price_geometric_asian_cpp(
     double S0, double K, double r, double u, double d,
     double lambda, double v_u, double v_d, int n,
-    std::string option_type = "call"
+    std::string option_type = "call",
+    int n_fixed = 0, double fixed_sum = 0.0, double fixed_log_sum = 0.0
 ) {
     if (option_type != "call" && option_type != "put") {
         Rcpp::stop("option_type must be either 'call' or 'put'");
     }
 
-    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+    Seasoning seasoning = make_seasoning(n_fixed, fixed_sum, fixed_log_sum);
 
-    std::vector<std::vector<int>> all_paths = generate_all_paths(n);
+    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
 
     double discount = std::pow(r, -n);
 
-    double option_value = 0.0;
-
-    for (const auto& path : all_paths) {
-        std::vector<double> prices = generate_price_path(S0, path,
-                                                         factors.u_tilde,
-                                                         factors.d_tilde);
-
-        double G = geometric_mean(prices);
+    GeometricSums sums = sum_geometric_payoffs(S0, K, n, factors,
+                                               option_type == "call",
+                                               seasoning);
 
-        double payoff;
-        if (option_type == "call") {
-            payoff = std::max(0.0, G - K);
-        } else {
-            payoff = std::max(0.0, K - G);
-        }
-
-        int n_ups = 0;
-        for (int move : path) {
-            if (move == 1) n_ups++;
-        }
-
-        double path_prob = std::pow(factors.p_adj, n_ups) *
-                          std::pow(1.0 - factors.p_adj, n - n_ups);
-
-        option_value += path_prob * payoff;
-    }
-
-    option_value *= discount;
+    double option_value = discount * sums.payoff;
 
     return option_value;
 }
@@ -149,6 +110,10 @@ double price_geometric_asian_cpp(
 //' @param n_simulations Number of Monte Carlo paths to simulate (default: 100000)
 //' @param option_type Type of option: "call" or "put" (default: "call")
 //' @param seed Random seed for reproducibility (default: -1 for no seed)
+//' @param n_fixed Number of fixings already realized before \code{S0}
+//'   (default: 0)
+//' @param fixed_sum Sum of the realized fixings (default: 0)
+//' @param fixed_log_sum Sum of the logs of the realized fixings (default: 0)
 //'
 //' @return A list containing:
 //' \itemize{
@@ -170,7 +135,9 @@ double price_geometric_asian_cpp(
 //' standard error = sd(payoffs) / sqrt(n_simulations).
 //'
 //' Monte Carlo is recommended for n > 20 where exact enumeration becomes
-//' computationally prohibitive (2^n paths).
+//' computationally prohibitive (2^n paths). Realized fixings of a seasoned
+//' option enter every simulated average as in
+//' \code{\link{price_geometric_asian_cpp}}.
 //'
 //' @references
 //' Glasserman, P. (2003). Monte Carlo Methods in Financial Engineering.
@@ -195,7 +162,8 @@ Rcpp::List price_geometric_asian_mc_cpp(
     double lambda, double v_u, double v_d, int n,
     int n_simulations = 100000,
     std::string option_type = "call",
-    int seed = -1
+    int seed = -1,
+    int n_fixed = 0, double fixed_sum = 0.0, double fixed_log_sum = 0.0
 ) {
     if (option_type != "call" && option_type != "put") {
         Rcpp::stop("option_type must be either 'call' or 'put'");
@@ -205,6 +173,8 @@ Rcpp::List price_geometric_asian_mc_cpp(
         Rcpp::stop("n_simulations must be positive");
     }
 
+    Seasoning seasoning = make_seasoning(n_fixed, fixed_sum, fixed_log_sum);
+
     if (seed >= 0) {
         Rcpp::Environment base_env("package:base");
         Rcpp::Function set_seed = base_env["set.seed"];
@@ -215,44 +185,17 @@ Rcpp::List price_geometric_asian_mc_cpp(
 
     double discount = std::pow(r, -n);
 
-    std::vector<double> payoffs(n_simulations);
-
     GetRNGstate();
 
-    for (int sim = 0; sim < n_simulations; ++sim) {
-        std::vector<int> path(n);
-        for (int i = 0; i < n; ++i) {
-            path[i] = (R::runif(0.0, 1.0) < factors.p_adj) ? 1 : 0;
-        }
-
-        std::vector<double> prices = generate_price_path(S0, path,
-                                                         factors.u_tilde,
-                                                         factors.d_tilde);
-
-        double G = geometric_mean(prices);
-
-        double payoff;
-        if (option_type == "call") {
-            payoff = std::max(0.0, G - K);
-        } else {
-            payoff = std::max(0.0, K - G);
-        }
-
-        payoffs[sim] = discount * payoff;
-    }
+    SimulatedSums sums = simulate_asian_payoffs(S0, K, n, factors,
+                                                option_type == "call", false,
+                                                seasoning, n_simulations,
+                                                discount);
 
     PutRNGstate();
 
-    double sum = 0.0;
-    double sum_sq = 0.0;
-
-    for (double payoff : payoffs) {
-        sum += payoff;
-        sum_sq += payoff * payoff;
-    }
-
-    double mean_price = sum / n_simulations;
-    double variance = (sum_sq / n_simulations) - (mean_price * mean_price);
+    double mean_price = sums.sum / n_simulations;
+    double variance = (sums.sum_sq / n_simulations) - (mean_price * mean_price);
     double std_error = std::sqrt(variance / n_simulations);
 
     return Rcpp::List::create(
@@ -0,0 +1,500 @@
+#include <Rcpp.h>
+#include "geometric_distribution.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+// Fills exponent, h and the cumulative sums from n, n_fixed, offset and
+// prob. When given, tilted[i] = P(W) h(W) / E[h] replaces the product
+// prob[i] h[i].
+static void tabulate_geometric_distribution(
+    GeometricDistribution& dist, const AdjustedFactors& factors,
+    const std::vector<double>* tilted = 0, double mean_h = 0.0
+) {
+    int n = dist.n;
+    int T = n * (n + 1) / 2;
+    double N = dist.n_fixed + n + 1;
+
+    dist.exponent = (n + 1) / N;
+
+    double log_ratio = std::log(factors.u_tilde / factors.d_tilde);
+    double log_base = T * std::log(factors.d_tilde);
+
+    size_t m = dist.prob.size();
+    dist.h.resize(m);
+    dist.cum_q.assign(m + 1, 0.0);
+    dist.cum_qh.assign(m + 1, 0.0);
+
+    for (size_t i = 0; i < m; ++i) {
+        double W = dist.offset + (double)i;
+        dist.h[i] = std::exp((W * log_ratio + log_base) / N);
+        dist.cum_q[i + 1] = dist.cum_q[i] + dist.prob[i];
+        double qh = tilted ? mean_h * (*tilted)[i] : dist.prob[i] * dist.h[i];
+        dist.cum_qh[i + 1] = dist.cum_qh[i] + qh;
+    }
+}
+
+// The recursion on a window [lo, lo + window.size()) of W. After weight k
+// the end states below the truncation are dropped, each crediting its mass
+// and its expected h at maturity: the weights k+1..n still to come are
+// independent, so E[h | W'] = h_0 e^(a W') prod_{j>k} (q + p e^(aj)) with
+// a = log(u_tilde / d_tilde) / N and h_0 = d_tilde^(T/N).
+static void build_truncated_distribution(
+    GeometricDistribution& dist, const AdjustedFactors& factors
+) {
+    int n = dist.n;
+    int T = n * (n + 1) / 2;
+    double N = dist.n_fixed + n + 1;
+    double p = factors.p_adj;
+    double q = 1.0 - p;
+    double a = std::log(factors.u_tilde / factors.d_tilde) / N;
+
+    // log_rest[k] = log prod_{j>k} (q + p e^(aj)) + log h_0
+    std::vector<double> log_rest(n + 1);
+    log_rest[n] = T * std::log(factors.d_tilde) / N;
+    for (int k = n; k >= 1; --k) {
+        log_rest[k - 1] = log_rest[k] + std::log(q + p * std::exp(a * k));
+    }
+
+    // Live states are buffer[begin..], the first of them at W = lo
+    std::vector<double> buffer(1, 1.0);
+    size_t begin = 0;
+    int lo = 0;
+
+    for (int k = 1; k <= n; ++k) {
+        size_t width = buffer.size() - begin;
+        buffer.resize(buffer.size() + k, 0.0);
+        double* v = &buffer[begin];
+        for (size_t i = width + k - 1; i >= (size_t)k; --i) {
+            v[i] = q * v[i] + p * v[i - k];
+        }
+        for (size_t i = 0; i < (size_t)k; ++i) {
+            v[i] *= q;
+        }
+
+        double log_tail = log_rest[k];
+        while (buffer.size() - begin > 1 && buffer[begin] < dist.truncation) {
+            double mass = buffer[begin];
+            dist.dropped_mass += mass;
+            dist.dropped_qh += mass * std::exp(a * lo + log_tail);
+            ++begin;
+            ++lo;
+        }
+        while (buffer.size() - begin > 1 && buffer.back() < dist.truncation) {
+            double mass = buffer.back();
+            int W = lo + (int)(buffer.size() - begin) - 1;
+            dist.dropped_mass += mass;
+            dist.dropped_qh += mass * std::exp(a * W + log_tail);
+            buffer.pop_back();
+        }
+
+        if (begin > buffer.size() / 2) {
+            buffer.erase(buffer.begin(), buffer.begin() + begin);
+            begin = 0;
+        }
+    }
+
+    dist.offset = lo;
+    dist.prob.assign(buffer.begin() + begin, buffer.end());
+    dist.error_bound = std::numeric_limits<double>::epsilon() * n;
+    tabulate_geometric_distribution(dist, factors);
+}
+
+GeometricDistribution build_geometric_distribution(
+    int n, const AdjustedFactors& factors, int n_fixed, int fft_min_steps,
+    double truncation
+) {
+    GeometricDistribution dist;
+    dist.n = n;
+    dist.n_fixed = n_fixed;
+    dist.offset = 0;
+    dist.checkpoint_stride = std::max(1, (int)std::ceil(std::sqrt((double)n)));
+    dist.error_bound = 0.0;
+    dist.truncation = truncation;
+    dist.dropped_mass = 0.0;
+    dist.dropped_qh = 0.0;
+
+    if (truncation > 0.0) {
+        build_truncated_distribution(dist, factors);
+        return dist;
+    }
+
+    int T = n * (n + 1) / 2;
+
+    if (n >= fft_min_steps) {
+        // P(W) h(W) spans too many orders of magnitude for the absolute error
+        // of an FFT, so it is built as a product of its own: tilting by
+        // h(W) ~ e^(a W), a = log(u_tilde / d_tilde) / N, turns the move of
+        // weight k into a Bernoulli(p e^(ak) / (q + p e^(ak))), and
+        // E[h] = d_tilde^(T/N) prod_k (q + p e^(ak)). The checkpoints would
+        // cost as much as the products themselves; rolling rebuilds instead.
+        double N = n_fixed + n + 1;
+        double a = std::log(factors.u_tilde / factors.d_tilde) / N;
+        double p = factors.p_adj;
+        double log_odds = std::log(p / (1.0 - p));
+        double log_mean_h = T * std::log(factors.d_tilde) / N;
+
+        std::vector<double> plain(n + 1, p);
+        std::vector<double> tilted(n + 1, 0.0);
+        for (int k = 1; k <= n; ++k) {
+            double x = log_odds + a * k;
+            tilted[k] = 1.0 / (1.0 + std::exp(-x));
+            log_mean_h += std::log(1.0 - p) +
+                          (x > 0.0 ? x + std::log1p(std::exp(-x))
+                                   : std::log1p(std::exp(x)));
+        }
+
+        std::vector<double> tilted_prob;
+        bernoulli_weight_products(plain, tilted, 1, n, dist.prob, tilted_prob,
+                                  dist.error_bound);
+        tabulate_geometric_distribution(dist, factors, &tilted_prob,
+                                        std::exp(log_mean_h));
+        return dist;
+    }
+
+    // Step j has weight n - j + 1, so the weights are 1..n in some order
+    std::vector<double> prob(T + 1, 0.0);
+    prob[0] = 1.0;
+    dist.checkpoints.push_back(std::vector<double>(1, 1.0));
+
+    int reach = 0;
+    for (int k = 1; k <= n; ++k) {
+        add_bernoulli_weight(prob, reach, k, factors.p_adj);
+        reach += k;
+
+        if (k % dist.checkpoint_stride == 0) {
+            dist.checkpoints.push_back(
+                std::vector<double>(prob.begin(), prob.begin() + reach + 1));
+        }
+    }
+
+    // Every update is a convex combination, adding one rounding per weight
+    dist.error_bound = std::numeric_limits<double>::epsilon() * n;
+    dist.prob.swap(prob);
+    tabulate_geometric_distribution(dist, factors);
+
+    return dist;
+}
+
+void build_geometric_distribution_pair(
+    int n, const AdjustedFactors& first_factors,
+    const AdjustedFactors& second_factors, int n_fixed,
+    GeometricDistribution& first, GeometricDistribution& second,
+    int fft_min_steps
+) {
+    if (n >= fft_min_steps) {
+        first = build_geometric_distribution(n, first_factors, n_fixed, fft_min_steps);
+        second = build_geometric_distribution(n, second_factors, n_fixed, fft_min_steps);
+        return;
+    }
+
+    int T = n * (n + 1) / 2;
+    double p1 = first_factors.p_adj;
+    double q1 = 1.0 - p1;
+    double p2 = second_factors.p_adj;
+    double q2 = 1.0 - p2;
+
+    // pair[2W] and pair[2W + 1] hold P(W) of the first and second side
+    std::vector<double> pair(2 * (T + 1), 0.0);
+    pair[0] = 1.0;
+    pair[1] = 1.0;
+
+    int reach = 0;
+    for (int k = 1; k <= n; ++k) {
+        for (int w = reach + k; w >= k; --w) {
+            pair[2 * w] = q1 * pair[2 * w] + p1 * pair[2 * (w - k)];
+            pair[2 * w + 1] = q2 * pair[2 * w + 1] + p2 * pair[2 * (w - k) + 1];
+        }
+        for (int w = k - 1; w >= 0; --w) {
+            pair[2 * w] *= q1;
+            pair[2 * w + 1] *= q2;
+        }
+        reach += k;
+    }
+
+    GeometricDistribution* sides[2] = {&first, &second};
+    const AdjustedFactors* factors[2] = {&first_factors, &second_factors};
+    for (int side = 0; side < 2; ++side) {
+        GeometricDistribution& dist = *sides[side];
+        dist.n = n;
+        dist.n_fixed = n_fixed;
+        dist.offset = 0;
+        dist.checkpoint_stride = std::max(1, (int)std::ceil(std::sqrt((double)n)));
+        dist.checkpoints.clear();
+        dist.error_bound = std::numeric_limits<double>::epsilon() * n;
+        dist.truncation = 0.0;
+        dist.dropped_mass = 0.0;
+        dist.dropped_qh = 0.0;
+
+        dist.prob.resize(T + 1);
+        for (int w = 0; w <= T; ++w) {
+            dist.prob[w] = pair[2 * w + side];
+        }
+        tabulate_geometric_distribution(dist, *factors[side]);
+    }
+}
+
+void roll_geometric_distribution(
+    GeometricDistribution& dist, const AdjustedFactors& factors
+) {
+    if (dist.n <= 0) {
+        Rcpp::stop("Cannot roll a distribution with no remaining steps");
+    }
+
+    int m = dist.n - 1;
+    int stride = dist.checkpoint_stride;
+
+    if (dist.checkpoints.empty()) {
+        dist = build_geometric_distribution(m, factors, dist.n_fixed + 1,
+                                            FFT_MIN_STEPS, dist.truncation);
+        return;
+    }
+
+    // Drop the layers that include the consumed weight
+    while ((int)(dist.checkpoints.size() - 1) * stride > m) {
+        dist.checkpoints.pop_back();
+    }
+
+    int start = (int)(dist.checkpoints.size() - 1) * stride;
+    int reach = start * (start + 1) / 2;
+
+    std::vector<double>& prob = dist.prob;
+    prob.assign(m * (m + 1) / 2 + 1, 0.0);
+    std::copy(dist.checkpoints.back().begin(), dist.checkpoints.back().end(),
+              prob.begin());
+
+    for (int k = start + 1; k <= m; ++k) {
+        add_bernoulli_weight(prob, reach, k, factors.p_adj);
+        reach += k;
+    }
+
+    dist.n = m;
+    dist.n_fixed += 1;
+    tabulate_geometric_distribution(dist, factors);
+}
+
+GeometricQuote quote_geometric(
+    const GeometricDistribution& dist,
+    double S0, double K, double scale,
+    bool is_call, double discount
+) {
+    double F = scale * std::pow(S0, dist.exponent);
+    double threshold = K / F;
+    double dF = dist.exponent * F / S0;
+
+    size_t m = dist.size();
+    double total_q = dist.cum_q[m];
+    double total_qh = dist.cum_qh[m];
+
+    GeometricQuote quote;
+
+    if (is_call) {
+        size_t idx = std::upper_bound(dist.h.begin(), dist.h.end(), threshold) -
+                     dist.h.begin();
+        double q_above = total_q - dist.cum_q[idx];
+        double qh_above = total_qh - dist.cum_qh[idx];
+        quote.price = discount * std::max(0.0, F * qh_above - K * q_above);
+        quote.delta = discount * dF * qh_above;
+        // Dropped paths pay at most G
+        quote.truncation_error = discount * F * dist.dropped_qh;
+    } else {
+        size_t idx = std::lower_bound(dist.h.begin(), dist.h.end(), threshold) -
+                     dist.h.begin();
+        quote.price = discount * std::max(0.0, K * dist.cum_q[idx] -
+                                                F * dist.cum_qh[idx]);
+        quote.delta = -discount * dF * dist.cum_qh[idx];
+        // Dropped paths pay at most K
+        quote.truncation_error = discount * K * dist.dropped_mass;
+    }
+
+    return quote;
+}
+
+// A geometric distribution seen from one spot, for strike ladders
+struct GeometricLadder {
+    double S0;
+    double scale;
+    double discount;
+    GeometricDistribution dist;
+};
+
+//' Build a Geometric Average Distribution for Strike Ladders
+//'
+//' Tabulates the exact distribution of the geometric average of the impacted
+//' binomial tree from \code{S0} once, so that any number of strikes can be
+//' priced with \code{\link{geometric_ladder_cpp}}.
+//'
+//' @param S0 Initial stock price (positive)
+//' @param r Gross risk-free rate per period
+//' @param u Base up factor in CRR model
+//' @param d Base down factor in CRR model
+//' @param lambda Price impact coefficient (non-negative)
+//' @param v_u Hedging volume on up move (non-negative)
+//' @param v_d Hedging volume on down move (non-negative)
+//' @param n Number of time steps (positive integer)
+//' @param n_fixed Number of fixings already realized before \code{S0}
+//'   (default: 0)
+//' @param fixed_log_sum Sum of the logs of the realized fixings (default: 0)
+//' @param method "auto" (default), "fft" or "recursion"
+//' @param truncation Probability below which states of the recursion are
+//'   dropped (default: 0, exact)
+//'
+//' @return External pointer to the distribution
+//'
+//' @details
+//' The log of the geometric average is affine in the weighted up-count
+//' \eqn{W = \sum_j (n-j+1) X_j}, whose law has the generating function
+//' \eqn{\prod_{k=1}^n (q + p x^k)}. The "recursion" method multiplies the
+//' factors in one at a time in \eqn{O(n^3)}; the "fft" method splits the
+//' weights in halves recursively and multiplies the partial products with
+//' FFT convolutions in \eqn{O(n^2 \log^2 n)}, with the probability-weighted
+//' average built from a second product tilted by the average so that its
+//' upper tail keeps full relative accuracy. "auto" uses the FFT from 1280
+//' steps on, where it overtakes the recursion.
+//'
+//' With a positive \code{truncation} the recursion keeps only a window of
+//' \eqn{W}: after each weight the states at either end with probability
+//' below \code{truncation} are dropped. The later weights are independent of
+//' the dropped partial count \eqn{W'}, so the exact expectation of the
+//' normalized average over the dropped paths follows from \eqn{W'} alone and
+//' is accumulated with their mass. Every price from the distribution is then
+//' a lower bound, within a guaranteed error (see
+//' \code{\link{geometric_ladder_cpp}}), at a cost proportional to the
+//' window instead of \eqn{n^2/2}.
+//'
+//' @export
+// [[Rcpp::export]]
+SEXP geometric_distribution_cpp(
+    double S0, double r, double u, double d,
+    double lambda, double v_u, double v_d, int n,
+    int n_fixed = 0, double fixed_log_sum = 0.0,
+    std::string method = "auto", double truncation = 0.0
+) {
+    if (n <= 0) {
+        Rcpp::stop("n must be a positive integer");
+    }
+    if (!(S0 > 0)) {
+        Rcpp::stop("S0 must be positive");
+    }
+    if (n_fixed < 0) {
+        Rcpp::stop("n_fixed must be non-negative");
+    }
+
+    int fft_min_steps;
+    if (method == "auto") {
+        fft_min_steps = FFT_MIN_STEPS;
+    } else if (method == "fft") {
+        fft_min_steps = 0;
+    } else if (method == "recursion") {
+        fft_min_steps = n + 1;
+    } else {
+        Rcpp::stop("method must be one of 'auto', 'fft' or 'recursion'");
+    }
+    if (!(truncation >= 0.0 && truncation < 1.0)) {
+        Rcpp::stop("truncation must be in [0, 1)");
+    }
+    if (truncation > 0.0 && method == "fft") {
+        Rcpp::stop("truncation applies to the recursion, not to the FFT products");
+    }
+
+    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+
+    GeometricLadder* ladder = new GeometricLadder();
+    Rcpp::XPtr<GeometricLadder> ptr(ladder, true);
+
+    ladder->S0 = S0;
+    ladder->scale = std::exp(fixed_log_sum / (n_fixed + n + 1));
+    ladder->discount = std::pow(r, -n);
+    ladder->dist = build_geometric_distribution(n, factors, n_fixed, fft_min_steps,
+                                                truncation);
+
+    return ptr;
+}
+
+//' Price a Geometric Asian Strike Ladder
+//'
+//' @param dist External pointer from \code{\link{geometric_distribution_cpp}}
+//' @param K Strike of each option (positive)
+//' @param option_type "call" or "put" for each option, same length as
+//'   \code{K}
+//'
+//' @return List of vectors \code{price}, \code{delta} and
+//'   \code{error_bound}
+//'
+//' @details
+//' Each strike is one binary search over the support of the average. The
+//' delta is the derivative of the price in \code{S0} for the fixed tree.
+//' For a truncated distribution the true price lies between \code{price}
+//' and \code{price + error_bound}: a dropped path pays at most the average
+//' (call) or the strike (put), whose expectations over the dropped paths are
+//' known exactly. \code{error_bound} is 0 without truncation.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List geometric_ladder_cpp(
+    SEXP dist, Rcpp::NumericVector K, std::vector<std::string> option_type
+) {
+    Rcpp::XPtr<GeometricLadder> ptr(dist);
+
+    int count = K.size();
+    if ((int)option_type.size() != count) {
+        Rcpp::stop("K and option_type must have the same length");
+    }
+
+    Rcpp::NumericVector price(count);
+    Rcpp::NumericVector delta(count);
+    Rcpp::NumericVector error_bound(count);
+
+    for (int i = 0; i < count; ++i) {
+        if (option_type[i] != "call" && option_type[i] != "put") {
+            Rcpp::stop("option_type must be either 'call' or 'put'");
+        }
+        GeometricQuote quote = quote_geometric(ptr->dist, ptr->S0, K[i],
+                                               ptr->scale,
+                                               option_type[i] == "call",
+                                               ptr->discount);
+        price[i] = quote.price;
+        delta[i] = quote.delta;
+        error_bound[i] = quote.truncation_error;
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("price") = price,
+        Rcpp::Named("delta") = delta,
+        Rcpp::Named("error_bound") = error_bound
+    );
+}
+
+//' Support of a Geometric Average Distribution
+//'
+//' @param dist External pointer from \code{\link{geometric_distribution_cpp}}
+//'
+//' @return List with the ascending support \code{G} of the geometric
+//'   average, its probabilities \code{prob}, \code{error_bound}, a bound
+//'   on the absolute rounding error of any probability, and
+//'   \code{dropped_mass}, the probability of the states dropped by
+//'   truncation
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List geometric_support_cpp(SEXP dist) {
+    Rcpp::XPtr<GeometricLadder> ptr(dist);
+    const GeometricDistribution& geometric = ptr->dist;
+
+    double F = ptr->scale * std::pow(ptr->S0, geometric.exponent);
+
+    size_t m = geometric.size();
+    Rcpp::NumericVector G(m);
+    Rcpp::NumericVector prob(m);
+    for (size_t w = 0; w < m; ++w) {
+        G[w] = F * geometric.h[w];
+        prob[w] = geometric.prob[w];
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("G") = G,
+        Rcpp::Named("prob") = prob,
+        Rcpp::Named("error_bound") = geometric.error_bound,
+        Rcpp::Named("dropped_mass") = geometric.dropped_mass
+    );
+}
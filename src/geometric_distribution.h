@@ -0,0 +1,89 @@
+#ifndef GEOMETRIC_DISTRIBUTION_H
+#define GEOMETRIC_DISTRIBUTION_H
+
+#include "utils.h"
+#include "polynomial_product.h"
+#include <vector>
+
+// Distribution of the geometric average normalized by the spot. With the
+// moves X_j in {0, 1} and the weighted up-count W = sum_j (n - j + 1) X_j,
+//   G = exp(L / N) * S0^((n+1)/N) * h(W),
+//   h(W) = exp((W log(u_tilde / d_tilde) + T log d_tilde) / N),
+// where T = n(n+1)/2, N = n_fixed + n + 1 and L is the log-sum of the
+// realized fixings. h depends on the moves only, so one table prices every
+// spot and strike.
+struct GeometricDistribution {
+    int n;
+    int n_fixed;
+    double exponent;           // (n + 1) / N, the power of S0 in G
+    int offset;                // W of prob[0]; 0 unless truncated
+    std::vector<double> prob;  // P(W) for W = offset..offset + size() - 1
+    // Bound on the absolute rounding error of any P(W), and of any
+    // P(W) h(W) / E[h] when built by FFT products
+    double error_bound;
+    // Truncated builds drop states with P below `truncation` on the way;
+    // dropped_mass is their total probability and dropped_qh their exact
+    // contribution to E[h] at maturity (both 0 without truncation)
+    double truncation;
+    double dropped_mass;
+    double dropped_qh;
+    // P(W) after the weights 1..c*stride only, for c*stride <= n; rolling
+    // restarts from the last of these instead of from scratch. Empty when
+    // the distribution was built by FFT products or truncated.
+    int checkpoint_stride;
+    std::vector<std::vector<double> > checkpoints;
+    std::vector<double> h;     // h(W) over the support, ascending
+    std::vector<double> cum_q;   // cum_q[i] = sum_{j<i} P(offset + j)
+    std::vector<double> cum_qh;  // cum_qh[i] = sum_{j<i} P(offset + j) h(offset + j)
+
+    size_t size() const { return h.size(); }
+};
+
+// P(W) by the O(n^3) dynamic programme over W, one weight per step, or for
+// n >= fft_min_steps as the product prod_k (q + p x^k) in O(n^2 log^2 n),
+// with P(W) h(W) from a second product tilted by h so that the upper tail
+// keeps its relative accuracy. With truncation > 0 the recursion instead
+// keeps a window of W, dropping the end states whose probability falls below
+// truncation after each weight, in O(n * window) time and O(window) memory.
+GeometricDistribution build_geometric_distribution(
+    int n, const AdjustedFactors& factors, int n_fixed = 0,
+    int fft_min_steps = FFT_MIN_STEPS, double truncation = 0.0
+);
+
+// The distributions of two sets of factors with the same n and n_fixed
+// (the bid and ask sides of a quote) from one pass of the recursion: W has
+// the same support on both sides, so the two P(W) are stored interleaved
+// and each weight updates both in the same sweep. The results carry no
+// checkpoints. From fft_min_steps on each side is built by its own products.
+void build_geometric_distribution_pair(
+    int n, const AdjustedFactors& first_factors,
+    const AdjustedFactors& second_factors, int n_fixed,
+    GeometricDistribution& first, GeometricDistribution& second,
+    int fft_min_steps = FFT_MIN_STEPS
+);
+
+// Advances the distribution one step after a fixing has been realized:
+// n -> n - 1 and n_fixed -> n_fixed + 1, so N is unchanged. The step just
+// taken carried the largest weight n, which the recursion added last, so
+// P(W) for n - 1 steps is rebuilt from the nearest checkpoint in
+// O(stride * n^2) and checkpoints above n - 1 are dropped. Without
+// checkpoints the distribution is rebuilt with the same truncation.
+void roll_geometric_distribution(
+    GeometricDistribution& dist, const AdjustedFactors& factors
+);
+
+struct GeometricQuote {
+    double price;
+    double delta;             // dV/dS0
+    double truncation_error;  // true price lies in [price, price + this]
+};
+
+// Discounted price and delta for spot S0 by one binary search over h.
+// scale = exp(L / N) carries the realized fixings (1 when unseasoned).
+GeometricQuote quote_geometric(
+    const GeometricDistribution& dist,
+    double S0, double K, double scale,
+    bool is_call, double discount
+);
+
+#endif
@@ -0,0 +1,263 @@
+#include <Rcpp.h>
+#include "utils.h"
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <stdint.h>
+
+// Exact joint law of the number of up moves k and the weighted up-count
+// W = sum_j (n - j + 1) X_j, compiled into a Walker alias table. A state
+// (k, W) fixes both the terminal price S0 u_tilde^k d_tilde^(n-k) and the
+// geometric average, so one draw costs two uniforms and two lookups,
+// whatever n is.
+struct GeometricSampler {
+    int n;
+    double discount;
+    std::vector<double> threshold;  // keep the drawn state when U < threshold
+    std::vector<uint32_t> alias;
+    std::vector<int> ups;           // k of each state
+    std::vector<int> weight;        // W of each state
+    std::vector<double> average;    // G for W = 0..n(n+1)/2
+    std::vector<double> terminal;   // S_n for k = 0..n
+};
+
+// P(k, W) for every k, as layers over W >= k(k+1)/2. The weights 1..n are
+// added one at a time; after the first m, layer k is non-zero on
+// [k(k+1)/2, k(2m-k+1)/2] only, so the build is O(n^4 / 24).
+static std::vector<std::vector<double> > joint_up_count_law(int n, double p) {
+    double q = 1.0 - p;
+
+    std::vector<std::vector<double> > layers(n + 1);
+    for (int k = 0; k <= n; ++k) {
+        layers[k].assign((size_t)k * (n - k) + 1, 0.0);
+    }
+    layers[0][0] = 1.0;
+
+    for (int m = 0; m < n; ++m) {
+        int w = m + 1;
+        for (int k = std::min(m, n - 1); k >= 0; --k) {
+            int low = k * (k + 1) / 2;
+            int high = k * (2 * m - k + 1) / 2;
+            int up_low = (k + 1) * (k + 2) / 2;
+
+            std::vector<double>& layer = layers[k];
+            std::vector<double>& up = layers[k + 1];
+            for (int W = low; W <= high; ++W) {
+                up[W + w - up_low] += p * layer[W - low];
+                layer[W - low] *= q;
+            }
+        }
+    }
+
+    return layers;
+}
+
+// Vose's construction: states with less than the average mass are topped
+// up by one state with more, which leaves at most one alias per state
+static void build_alias_table(const std::vector<double>& prob,
+                              std::vector<double>& threshold,
+                              std::vector<uint32_t>& alias) {
+    size_t M = prob.size();
+    double total = 0.0;
+    for (size_t i = 0; i < M; ++i) {
+        total += prob[i];
+    }
+
+    threshold.resize(M);
+    alias.resize(M);
+
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (size_t i = 0; i < M; ++i) {
+        threshold[i] = prob[i] * M / total;
+        alias[i] = (uint32_t)i;
+        if (threshold[i] < 1.0) {
+            small.push_back((uint32_t)i);
+        } else {
+            large.push_back((uint32_t)i);
+        }
+    }
+
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back();
+        small.pop_back();
+        uint32_t l = large.back();
+
+        alias[s] = l;
+        threshold[l] -= 1.0 - threshold[s];
+        if (threshold[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Whatever is left is 1 up to rounding
+    for (size_t i = 0; i < small.size(); ++i) {
+        threshold[small[i]] = 1.0;
+    }
+    for (size_t i = 0; i < large.size(); ++i) {
+        threshold[large[i]] = 1.0;
+    }
+}
+
+//' Build an Exact Sampler for the Geometric Average and Terminal Price
+//'
+//' Compiles the exact joint law of the geometric average \eqn{G} and the
+//' terminal price \eqn{S_n} of the impacted binomial tree into an alias
+//' table, so that \code{\link{geometric_sampler_draw_cpp}} draws each pair in
+//' \eqn{O(1)}.
+//'
+//' @param S0 Initial stock price (positive)
+//' @param r Gross risk-free rate per period
+//' @param u Base up factor in CRR model
+//' @param d Base down factor in CRR model
+//' @param lambda Price impact coefficient (non-negative)
+//' @param v_u Hedging volume on up move (non-negative)
+//' @param v_d Hedging volume on down move (non-negative)
+//' @param n Number of time steps (positive integer)
+//' @param n_fixed Number of fixings already realized before \code{S0}
+//'   (default: 0)
+//' @param fixed_log_sum Sum of the logs of the realized fixings (default: 0)
+//'
+//' @return External pointer to the sampler
+//'
+//' @details
+//' \eqn{G} is a function of the weighted up-count
+//' \eqn{W = \sum_j (n-j+1) X_j} and \eqn{S_n} of the number of up moves
+//' \eqn{k}, so the pair takes one value per state \eqn{(k, W)}. For each
+//' \eqn{k} the count \eqn{W} ranges over \eqn{k(n-k) + 1} consecutive
+//' values, giving about \eqn{n^3/6} states in all. Their probabilities are
+//' built by adding the weights one at a time in \eqn{O(n^4)}, and Vose's
+//' method turns them into an alias table in \eqn{O(n^3)}.
+//'
+//' @export
+// [[Rcpp::export]]
+SEXP geometric_sampler_cpp(
+    double S0, double r, double u, double d,
+    double lambda, double v_u, double v_d, int n,
+    int n_fixed = 0, double fixed_log_sum = 0.0
+) {
+    if (n <= 0) {
+        Rcpp::stop("n must be a positive integer");
+    }
+    if (!(S0 > 0)) {
+        Rcpp::stop("S0 must be positive");
+    }
+    if (n_fixed < 0) {
+        Rcpp::stop("n_fixed must be non-negative");
+    }
+
+    double states = 0.0;
+    for (int k = 0; k <= n; ++k) {
+        states += (double)k * (n - k) + 1;
+    }
+    if (states > (double)std::numeric_limits<uint32_t>::max()) {
+        Rcpp::stop("n is too large for an alias table over (k, W)");
+    }
+
+    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+
+    GeometricSampler* sampler = new GeometricSampler();
+    Rcpp::XPtr<GeometricSampler> ptr(sampler, true);
+
+    sampler->n = n;
+    sampler->discount = std::pow(r, -n);
+
+    int T = n * (n + 1) / 2;
+    double N = n_fixed + n + 1;
+    double log_u = std::log(factors.u_tilde);
+    double log_d = std::log(factors.d_tilde);
+    double log_S0 = std::log(S0);
+
+    // log G = (L + (n+1) log S0 + W log u + (T - W) log d) / N
+    sampler->average.resize(T + 1);
+    for (int W = 0; W <= T; ++W) {
+        sampler->average[W] = std::exp((fixed_log_sum + (n + 1) * log_S0 +
+                                        W * log_u + (T - W) * log_d) / N);
+    }
+
+    sampler->terminal.resize(n + 1);
+    for (int k = 0; k <= n; ++k) {
+        sampler->terminal[k] = std::exp(log_S0 + k * log_u + (n - k) * log_d);
+    }
+
+    std::vector<std::vector<double> > layers = joint_up_count_law(n, factors.p_adj);
+
+    std::vector<double> prob;
+    prob.reserve((size_t)states);
+    sampler->ups.reserve((size_t)states);
+    sampler->weight.reserve((size_t)states);
+
+    for (int k = 0; k <= n; ++k) {
+        int low = k * (k + 1) / 2;
+        const std::vector<double>& layer = layers[k];
+        for (size_t i = 0; i < layer.size(); ++i) {
+            if (layer[i] > 0.0) {
+                prob.push_back(layer[i]);
+                sampler->ups.push_back(k);
+                sampler->weight.push_back(low + (int)i);
+            }
+        }
+        std::vector<double>().swap(layers[k]);
+    }
+
+    build_alias_table(prob, sampler->threshold, sampler->alias);
+
+    return ptr;
+}
+
+//' Draw Geometric Averages and Terminal Prices from an Exact Sampler
+//'
+//' @param sampler External pointer from \code{\link{geometric_sampler_cpp}}
+//' @param n_samples Number of draws (positive integer)
+//' @param seed Random seed for reproducibility (default: -1 for no seed)
+//'
+//' @return List with vectors \code{G} and \code{S_n} of length
+//'   \code{n_samples}, and the scalar \code{discount} \eqn{r^{-n}}
+//'
+//' @details
+//' Each draw picks a state uniformly with \code{R_unif_index}, the unbiased
+//' index draw behind \code{sample()}, and keeps it or moves to its alias by
+//' a second uniform, using R's random number generator.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List geometric_sampler_draw_cpp(SEXP sampler, int n_samples, int seed = -1) {
+    Rcpp::XPtr<GeometricSampler> ptr(sampler);
+
+    if (n_samples <= 0) {
+        Rcpp::stop("n_samples must be positive");
+    }
+
+    if (seed >= 0) {
+        Rcpp::Environment base_env("package:base");
+        Rcpp::Function set_seed = base_env["set.seed"];
+        set_seed(seed);
+    }
+
+    const GeometricSampler& s = *ptr;
+    size_t M = s.threshold.size();
+
+    Rcpp::NumericVector G(n_samples);
+    Rcpp::NumericVector S_n(n_samples);
+
+    GetRNGstate();
+
+    for (int i = 0; i < n_samples; ++i) {
+        size_t state = (size_t)R_unif_index((double)M);
+        if (R::runif(0.0, 1.0) >= s.threshold[state]) {
+            state = s.alias[state];
+        }
+
+        G[i] = s.average[s.weight[state]];
+        S_n[i] = s.terminal[s.ups[state]];
+    }
+
+    PutRNGstate();
+
+    return Rcpp::List::create(
+        Rcpp::Named("G") = G,
+        Rcpp::Named("S_n") = S_n,
+        Rcpp::Named("discount") = s.discount
+    );
+}
@@ -0,0 +1,342 @@
+#include <Rcpp.h>
+#include "utils.h"
+#include "geometric_distribution.h"
+#include "scratch_arena.h"
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Paths per simulation block. Each block's draws are taken from R's RNG on
+// the calling thread, then its paths are hedged in parallel, so results do
+// not depend on the thread count.
+static const int HEDGE_BLOCK = 16384;
+
+// The residual tables for all n - 1 steps take about 4 n^3 bytes, which is
+// kept below 2 GiB (n up to 812)
+static const double HEDGE_TABLE_MAX_BYTES = 2147483648.0;
+
+// Value tables of the short geometric Asian option after each step:
+// residual[t] prices the option at step t + 1 (n - t - 1 steps left, t + 1
+// fixings realized) for any spot and realized log-sum, for t < n - 1
+struct HedgeTables {
+    int n;
+    double N;
+    double K;
+    double log_K;
+    bool is_call;
+    double log_u;
+    double log_d;
+    double spread;  // u_tilde - d_tilde
+    std::vector<GeometricDistribution> residual;
+    std::vector<double> discount;  // r^-(n - t - 1)
+    // h[i] = exp(log_h0 + i * log_step) on every support, so the strike's
+    // position is found in O(1) instead of by binary search
+    std::vector<double> log_h0;
+    std::vector<double> log_step;
+};
+
+// Bytes of the residual tables: h and the two cumulative sums over the
+// m(m+1)/2 + 1 values of W for m = 1..n-1 remaining steps
+static double hedge_table_bytes(int n) {
+    double total = 0.0;
+    for (int m = 1; m < n; ++m) {
+        total += 3.0 * sizeof(double) * (0.5 * m * (m + 1) + 2.0);
+    }
+    return total;
+}
+
+// Value at step t + 1 with log-spot log_S, where log_sum covers S_0..S_t
+static double option_value_at(
+    const HedgeTables& tables, int t, double log_S, double log_sum
+) {
+    if (t == tables.n - 1) {
+        double G = std::exp((log_sum + log_S) / tables.N);
+        return tables.is_call ? std::max(0.0, G - tables.K)
+                              : std::max(0.0, tables.K - G);
+    }
+
+    const GeometricDistribution& dist = tables.residual[t];
+    double log_F = log_sum / tables.N + dist.exponent * log_S;
+    double F = std::exp(log_F);
+    double threshold = tables.K / F;
+
+    // First index with h above the threshold (calls) or at least at it
+    // (puts), as upper_bound and lower_bound would find it
+    long long size = (long long)dist.size();
+    long long idx = 0;
+    if (size > 1) {
+        double guess = (tables.log_K - log_F - tables.log_h0[t]) / tables.log_step[t];
+        idx = (long long)std::ceil(std::min((double)size, std::max(0.0, guess)));
+    }
+    if (tables.is_call) {
+        while (idx > 0 && dist.h[idx - 1] > threshold) --idx;
+        while (idx < size && dist.h[idx] <= threshold) ++idx;
+    } else {
+        while (idx > 0 && dist.h[idx - 1] >= threshold) --idx;
+        while (idx < size && dist.h[idx] < threshold) ++idx;
+    }
+
+    double value;
+    if (tables.is_call) {
+        double q_above = dist.cum_q[size] - dist.cum_q[idx];
+        double qh_above = dist.cum_qh[size] - dist.cum_qh[idx];
+        value = F * qh_above - tables.K * q_above;
+    } else {
+        value = tables.K * dist.cum_q[idx] - F * dist.cum_qh[idx];
+    }
+    return tables.discount[t] * std::max(0.0, value);
+}
+
+// Replicating delta at step t: the one-step difference quotient of the
+// option value over the two tree successors of S_t
+static double replicating_delta(
+    const HedgeTables& tables, int t, double S, double log_S, double log_sum
+) {
+    double next_log_sum = log_sum + log_S;
+    double value_up = option_value_at(tables, t, log_S + tables.log_u, next_log_sum);
+    double value_down = option_value_at(tables, t, log_S + tables.log_d, next_log_sum);
+    return (value_up - value_down) / (S * tables.spread);
+}
+
+// Trading x shares at mid S executes at S exp(cost_lambda * x); returns the
+// cash paid, of which x S (exp(cost_lambda * x) - 1) >= 0 is impact cost
+static inline double trade_cash(double x, double S, double cost_lambda, double& cost) {
+    double executed = x * S * std::exp(cost_lambda * x);
+    cost += executed - x * S;
+    return executed;
+}
+
+//' Delta-Hedging Backtest of a Short Geometric Asian Option with Price Impact
+//'
+//' Sells a geometric Asian option at its model price and rebalances the
+//' replicating delta of the impacted tree at every step along simulated
+//' paths, paying an impact cost on each trade.
+//'
+//' @param S0 Initial stock price (positive)
+//' @param K Strike price (positive)
+//' @param r Gross risk-free rate per period
+//' @param u Base up factor in CRR model
+//' @param d Base down factor in CRR model
+//' @param lambda Price impact coefficient of the model (non-negative)
+//' @param v_u Hedging volume on up move (non-negative)
+//' @param v_d Hedging volume on down move (non-negative)
+//' @param n Number of time steps (positive integer)
+//' @param n_paths Number of simulated paths
+//' @param option_type "call" or "put"
+//' @param paths "impacted" (moves u_tilde or d_tilde) or "gbm"
+//' @param p_up Probability of an up move on impacted paths
+//' @param drift Mean log-return per step on GBM paths
+//' @param vol Standard deviation of the log-return per step on GBM paths
+//' @param notional Number of options sold
+//' @param cost_lambda Impact coefficient charged on the hedge trades
+//' @param seed Random seed (negative for none)
+//' @param n_threads Threads for hedging each block of paths
+//'
+//' @return List with the option \code{premium} (per option) and, per path,
+//'   the discounted hedging \code{pnl} and impact \code{cost} and the
+//'   share \code{turnover}
+//'
+//' @details
+//' At step \eqn{t} the hedge holds \code{notional} times
+//' \eqn{\Delta_t = (V_{t+1}(S_t \tilde{u}) - V_{t+1}(S_t \tilde{d})) /
+//' (S_t (\tilde{u} - \tilde{d}))}, with \eqn{V_{t+1}} quoted from the exact
+//' distribution of the geometric average for the residual tree. The
+//' distributions for all steps are built once, by rolling, and shared by
+//' every path. Together they hold about \eqn{4 n^3} bytes (4 GB at
+//' \eqn{n = 1000}), so \eqn{n} is limited to 812 (2 GiB). Trading \eqn{x}
+//' shares at mid \eqn{S} costs \eqn{x S e^{\lambda_c x}}, and the position
+//' is unwound at maturity.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List hedge_backtest_cpp(
+    double S0, double K, double r, double u, double d,
+    double lambda, double v_u, double v_d, int n,
+    int n_paths = 100000,
+    std::string option_type = "call",
+    std::string paths = "impacted",
+    double p_up = NA_REAL,
+    double drift = NA_REAL,
+    double vol = NA_REAL,
+    double notional = 1.0,
+    double cost_lambda = NA_REAL,
+    int seed = -1,
+    int n_threads = 1
+) {
+    if (n <= 0) {
+        Rcpp::stop("n must be a positive integer");
+    }
+    if (n_paths <= 0) {
+        Rcpp::stop("n_paths must be a positive integer");
+    }
+    if (option_type != "call" && option_type != "put") {
+        Rcpp::stop("option_type must be either 'call' or 'put'");
+    }
+    if (paths != "impacted" && paths != "gbm") {
+        Rcpp::stop("paths must be either 'impacted' or 'gbm'");
+    }
+    if (n_threads < 1) {
+        Rcpp::stop("n_threads must be a positive integer");
+    }
+    if (hedge_table_bytes(n) > HEDGE_TABLE_MAX_BYTES) {
+        int max_n = n;
+        while (hedge_table_bytes(max_n) > HEDGE_TABLE_MAX_BYTES) {
+            --max_n;
+        }
+        Rcpp::stop("n = " + std::to_string(n) + " needs " +
+                   std::to_string((long long)(hedge_table_bytes(n) / 1e6)) +
+                   " MB of residual distributions (O(n^3)); n must be at most " +
+                   std::to_string(max_n));
+    }
+
+    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+    double log_u = std::log(factors.u_tilde);
+    double log_d = std::log(factors.d_tilde);
+    double p = factors.p_adj;
+
+    // Unset path parameters default to the risk-neutral tree
+    if (ISNAN(p_up)) {
+        p_up = p;
+    }
+    if (ISNAN(drift)) {
+        drift = p * log_u + (1.0 - p) * log_d;
+    }
+    if (ISNAN(vol)) {
+        vol = std::sqrt(p * (1.0 - p)) * (log_u - log_d);
+    }
+    if (ISNAN(cost_lambda)) {
+        cost_lambda = lambda;
+    }
+    if (!(p_up >= 0.0 && p_up <= 1.0)) {
+        Rcpp::stop("p_up must be in [0, 1]");
+    }
+    if (!(vol >= 0.0)) {
+        Rcpp::stop("vol must be non-negative");
+    }
+    if (!(cost_lambda >= 0.0)) {
+        Rcpp::stop("cost_lambda must be non-negative");
+    }
+
+    bool is_call = (option_type == "call");
+    bool gbm = (paths == "gbm");
+
+    HedgeTables tables;
+    tables.n = n;
+    tables.N = n + 1;
+    tables.K = K;
+    tables.log_K = std::log(K);
+    tables.is_call = is_call;
+    tables.log_u = log_u;
+    tables.log_d = log_d;
+    tables.spread = factors.u_tilde - factors.d_tilde;
+
+    double premium = quote_geometric(build_geometric_distribution(n, factors),
+                                     S0, K, 1.0, is_call, std::pow(r, -n)).price;
+
+    if (n > 1) {
+        GeometricDistribution dist = build_geometric_distribution(n - 1, factors, 1);
+        for (int t = 0; t < n - 1; ++t) {
+            if (t > 0) {
+                roll_geometric_distribution(dist, factors);
+            }
+            tables.residual.push_back(dist);
+            // Quotes read only h and the cumulative sums
+            GeometricDistribution& table = tables.residual.back();
+            table.prob = std::vector<double>();
+            table.checkpoints = std::vector<std::vector<double> >();
+            tables.discount.push_back(std::pow(r, -(n - t - 1)));
+
+            size_t last = table.size() - 1;
+            tables.log_h0.push_back(std::log(table.h[0]));
+            tables.log_step.push_back(
+                last > 0 ? std::log(table.h[last] / table.h[0]) / last : 1.0);
+        }
+    }
+
+    if (seed >= 0) {
+        Rcpp::Environment base_env("package:base");
+        Rcpp::Function set_seed = base_env["set.seed"];
+        set_seed(seed);
+    }
+
+    Rcpp::NumericVector pnl(n_paths);
+    Rcpp::NumericVector cost(n_paths);
+    Rcpp::NumericVector turnover(n_paths);
+    double* pnl_out = pnl.begin();
+    double* cost_out = cost.begin();
+    double* turnover_out = turnover.begin();
+
+    double final_discount = std::pow(r, -n);
+
+    ScratchFrame frame;
+    double* draws = frame.allocate<double>((size_t)HEDGE_BLOCK * n);
+
+    for (int first = 0; first < n_paths; first += HEDGE_BLOCK) {
+        int count = std::min(HEDGE_BLOCK, n_paths - first);
+
+        // Log-returns of the block, path-major
+        GetRNGstate();
+        for (int i = 0; i < count; ++i) {
+            double* z = draws + (size_t)i * n;
+            for (int t = 0; t < n; ++t) {
+                z[t] = gbm ? drift + vol * R::rnorm(0.0, 1.0)
+                           : (R::runif(0.0, 1.0) < p_up ? log_u : log_d);
+            }
+        }
+        PutRNGstate();
+
+        #pragma omp parallel for num_threads(n_threads) schedule(static)
+        for (int i = 0; i < count; ++i) {
+            const double* z = draws + (size_t)i * n;
+            double S = S0;
+            double log_S = std::log(S0);
+            double log_sum = 0.0;  // logs of S_0..S_{t-1}
+            double position = 0.0;
+            double cash = notional * premium;
+            double path_cost = 0.0;
+            double path_turnover = 0.0;
+            double growth = 1.0;  // r^t
+
+            for (int t = 0; t < n; ++t) {
+                double target = notional * replicating_delta(tables, t, S, log_S, log_sum);
+                double x = target - position;
+                double step_cost = 0.0;
+                cash -= trade_cash(x, S, cost_lambda, step_cost);
+                path_cost += step_cost / growth;
+                path_turnover += std::fabs(x);
+                position = target;
+
+                log_sum += log_S;
+                log_S += z[t];
+                S = std::exp(log_S);
+                cash *= r;
+                growth *= r;
+            }
+
+            log_sum += log_S;
+            double G = std::exp(log_sum / tables.N);
+            double payoff = is_call ? std::max(0.0, G - K) : std::max(0.0, K - G);
+
+            double step_cost = 0.0;
+            cash -= trade_cash(-position, S, cost_lambda, step_cost);
+            path_cost += step_cost / growth;
+            path_turnover += std::fabs(position);
+
+            pnl_out[first + i] = final_discount * (cash - notional * payoff);
+            cost_out[first + i] = path_cost;
+            turnover_out[first + i] = path_turnover;
+        }
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("premium") = premium,
+        Rcpp::Named("pnl") = pnl,
+        Rcpp::Named("cost") = cost,
+        Rcpp::Named("turnover") = turnover
+    );
+}
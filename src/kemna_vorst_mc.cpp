@@ -1,7 +1,26 @@
 #include <Rcpp.h>
+#include "utils.h"
+#include "scratch_arena.h"
 #include <cmath>
 using namespace Rcpp;
 
+static double sample_mean(const double* x, int M) {
+  double sum = 0.0;
+  for (int j = 0; j < M; j++) {
+    sum += x[j];
+  }
+  return sum / M;
+}
+
+static double sample_sd(const double* x, int M) {
+  double mean = sample_mean(x, M);
+  double ss = 0.0;
+  for (int j = 0; j < M; j++) {
+    ss += (x[j] - mean) * (x[j] - mean);
+  }
+  return std::sqrt(ss / (M - 1));
+}
+
 //' Kemna-Vorst Monte Carlo Simulation for Arithmetic Average Asian Option
 //'
 //' Implements the Kemna-Vorst (1990) Monte Carlo method with variance reduction
@@ -19,6 +38,10 @@ using namespace Rcpp;
 //' @param option_type String: "call" or "put"
 //' @param use_control_variate Boolean: use variance reduction (default TRUE)
 //' @param seed Integer: random seed for reproducibility (default 0 = no seed)
+//' @param n_fixed Number of fixings already realized before \code{S0}
+//'   (default: 0)
+//' @param fixed_sum Sum of the realized fixings (default: 0)
+//' @param fixed_log_sum Sum of the logs of the realized fixings (default: 0)
 //'
 //' @return List containing:
 //' \describe{
@@ -54,6 +77,13 @@ using namespace Rcpp;
 //' The variance reduction can be dramatic (factor 10-70) because the
 //' correlation between arithmetic and geometric averages is typically > 0.95.
 //'
+//' For a seasoned option with \eqn{k} = \code{n_fixed} realized fixings,
+//' only the residual path from \code{S0} is simulated and both averages run
+//' over \eqn{N = k + n + 1} prices. With \eqn{w = (n+1)/N}, the log of the
+//' seasoned geometric average has mean \code{fixed_log_sum}\eqn{/N + w\mu}
+//' and standard deviation \eqn{w s}, where \eqn{\mu} and \eqn{s} are those
+//' of the unseasoned average; the analytical control variate uses these.
+//'
 //' @references
 //' Kemna, A.G.Z. and Vorst, A.C.F. (1990). "A Pricing Method for Options Based
 //' on Average Asset Values." \emph{Journal of Banking and Finance}, 14, 113-129.
@@ -77,8 +107,12 @@ List price_kemna_vorst_arithmetic_cpp(
     double T0, double T, int n, int M,
     std::string option_type = "call",
     bool use_control_variate = true,
-    int seed = 0
+    int seed = 0,
+    int n_fixed = 0, double fixed_sum = 0.0, double fixed_log_sum = 0.0
 ) {
+  Seasoning seasoning = make_seasoning(n_fixed, fixed_sum, fixed_log_sum);
+  double N = seasoning.count + n + 1;
+
   if (seed != 0) {
     Rcpp::Environment base_env("package:base");
     Rcpp::Function set_seed = base_env["set.seed"];
@@ -99,7 +133,24 @@ List price_kemna_vorst_arithmetic_cpp(
   double d2 = d - sigma_G * std::sqrt(tau);
 
   double geometric_price;
-  if (option_type == "call") {
+  if (seasoning.count > 0) {
+    // log G of the residual path is N(mu, s^2); the seasoned average
+    // scales it by w and shifts it by the realized log-sum
+    double w = (n + 1) / N;
+    double s_G = w * sigma_G * std::sqrt(tau);
+    double mu_G = seasoning.log_sum / N +
+                  w * (std::log(S0) + 0.5 * (r - 0.5 * sigma * sigma) * tau);
+    double d_G = (mu_G - std::log(K) + s_G * s_G) / s_G;
+    double forward_G = std::exp(mu_G + 0.5 * s_G * s_G);
+
+    if (option_type == "call") {
+      geometric_price = forward_G * R::pnorm(d_G, 0.0, 1.0, 1, 0) -
+                        K * R::pnorm(d_G - s_G, 0.0, 1.0, 1, 0);
+    } else {
+      geometric_price = K * R::pnorm(s_G - d_G, 0.0, 1.0, 1, 0) -
+                        forward_G * R::pnorm(-d_G, 0.0, 1.0, 1, 0);
+    }
+  } else if (option_type == "call") {
     geometric_price = std::exp(d_star) * S0 * R::pnorm(d, 0.0, 1.0, 1, 0) -
                       K * R::pnorm(d2, 0.0, 1.0, 1, 0);
   } else {
@@ -107,12 +158,13 @@ List price_kemna_vorst_arithmetic_cpp(
                       std::exp(d_star) * S0 * R::pnorm(-d, 0.0, 1.0, 1, 0);
   }
 
-  NumericVector arithmetic_payoffs(M);
-  NumericVector geometric_payoffs(M);
-  NumericVector differences(M);
+  ScratchFrame frame;
+  double* arithmetic_payoffs = frame.allocate<double>(M);
+  double* geometric_payoffs = frame.allocate<double>(M);
+  double* differences = frame.allocate<double>(M);
+  double* S = frame.allocate<double>(n + 1);
 
   for (int j = 0; j < M; j++) {
-    NumericVector S(n + 1);
     S[0] = S0;
 
     double log_S = std::log(S0);
@@ -127,13 +179,13 @@ List price_kemna_vorst_arithmetic_cpp(
       sum_log_S += log_S;
     }
 
-    double A = 0.0;
+    double A = seasoning.sum;
     for (int i = 0; i <= n; i++) {
       A += S[i];
     }
-    A /= (n + 1);
+    A /= N;
 
-    double G = std::exp(sum_log_S / (n + 1));
+    double G = std::exp((seasoning.log_sum + sum_log_S) / N);
 
     double Y, W;
     if (option_type == "call") {
@@ -149,8 +201,8 @@ List price_kemna_vorst_arithmetic_cpp(
     differences[j] = Y - W;
   }
 
-  double mean_diff = Rcpp::mean(differences);
-  double std_diff = Rcpp::sd(differences);
+  double mean_diff = sample_mean(differences, M);
+  double std_diff = sample_sd(differences, M);
 
   double price_estimate;
   double std_error;
@@ -159,8 +211,8 @@ List price_kemna_vorst_arithmetic_cpp(
     price_estimate = geometric_price + mean_diff;
     std_error = std_diff / std::sqrt(M);
   } else {
-    double mean_arith = Rcpp::mean(arithmetic_payoffs);
-    double std_arith = Rcpp::sd(arithmetic_payoffs);
+    double mean_arith = sample_mean(arithmetic_payoffs, M);
+    double std_arith = sample_sd(arithmetic_payoffs, M);
     price_estimate = mean_arith;
     std_error = std_arith / std::sqrt(M);
   }
@@ -171,8 +223,8 @@ List price_kemna_vorst_arithmetic_cpp(
 
   double correlation = 0.0;
   if (use_control_variate) {
-    double mean_Y = Rcpp::mean(arithmetic_payoffs);
-    double mean_W = Rcpp::mean(geometric_payoffs);
+    double mean_Y = sample_mean(arithmetic_payoffs, M);
+    double mean_W = sample_mean(geometric_payoffs, M);
     double cov = 0.0;
     double var_Y = 0.0;
     double var_W = 0.0;
@@ -224,6 +276,10 @@ List price_kemna_vorst_arithmetic_cpp(
 //' @param option_type String: "call" or "put"
 //' @param use_control_variate Boolean: use variance reduction
 //' @param seed Integer: random seed
+//' @param n_fixed Number of fixings already realized before \code{S0}
+//'   (default: 0)
+//' @param fixed_sum Sum of the realized fixings (default: 0)
+//' @param fixed_log_sum Sum of the logs of the realized fixings (default: 0)
 //'
 //' @return List with pricing results (same as price_kemna_vorst_arithmetic_cpp)
 //'
@@ -234,7 +290,8 @@ List price_kemna_vorst_arithmetic_binomial_cpp(
     int n, int M,
     std::string option_type = "call",
     bool use_control_variate = true,
-    int seed = 0
+    int seed = 0,
+    int n_fixed = 0, double fixed_sum = 0.0, double fixed_log_sum = 0.0
 ) {
   double r_continuous = std::log(r);
 
@@ -245,6 +302,7 @@ List price_kemna_vorst_arithmetic_binomial_cpp(
   return price_kemna_vorst_arithmetic_cpp(
     S0, K, r_continuous, sigma,
     0.0, 1.0,
-    n, M, option_type, use_control_variate, seed
+    n, M, option_type, use_control_variate, seed,
+    n_fixed, fixed_sum, fixed_log_sum
   );
 }
@@ -0,0 +1,315 @@
+#include <Rcpp.h>
+#include "utils.h"
+#include "geometric_distribution.h"
+#include <vector>
+#include <map>
+#include <cmath>
+
+// In-memory book of geometric Asian options. Each option keeps an index into
+// a shared normalized distribution (one per (n, n_fixed)), so a spot tick
+// costs one binary search per option on that underlying.
+struct LiveBook {
+    struct Position {
+        int distribution;
+        int underlying;
+        double K;
+        double log_sum;   // L, log-sum of the realized fixings
+        double scale;     // exp(L / N)
+        double discount;
+        bool is_call;
+        bool expired;
+    };
+
+    AdjustedFactors factors;
+    double r;
+    std::vector<GeometricDistribution> distributions;
+    std::vector<Position> positions;
+    std::vector<std::vector<int> > by_underlying;
+
+    // Latest marks, updated in place; R only ever receives copies
+    Rcpp::NumericVector spot;
+    Rcpp::NumericVector price;
+    Rcpp::NumericVector delta;
+
+    void reprice(int i) {
+        const Position& pos = positions[i];
+        if (pos.expired) {
+            return;
+        }
+        GeometricQuote quote = quote_geometric(distributions[pos.distribution],
+                                               spot[pos.underlying], pos.K,
+                                               pos.scale, pos.is_call,
+                                               pos.discount);
+        price[i] = quote.price;
+        delta[i] = quote.delta;
+    }
+};
+
+//' Create a Live Book of Geometric Asian Options
+//'
+//' Builds an in-memory book of geometric Asian options that is repriced
+//' incrementally on spot ticks with \code{\link{live_book_update_cpp}}.
+//'
+//' @param K Strike of each option (positive)
+//' @param n Remaining time steps of each option (positive integers)
+//' @param option_type "call" or "put" for each option
+//' @param underlying Underlying index of each option (1-based into \code{spot})
+//' @param spot Initial spot of each underlying (positive)
+//' @param r Gross risk-free rate per period
+//' @param u Base up factor in CRR model
+//' @param d Base down factor in CRR model
+//' @param lambda Price impact coefficient (non-negative)
+//' @param v_u Hedging volume on up move (non-negative)
+//' @param v_d Hedging volume on down move (non-negative)
+//' @param n_fixed Number of realized fixings of each option
+//' @param fixed_log_sum Log-sum of the realized fixings of each option
+//'
+//' @return External pointer to the book
+//'
+//' @details
+//' The geometric average factors as
+//' \eqn{G = e^{L/N} S_0^{(n+1)/N} h(W)} with \eqn{W} the weighted up-count
+//' \eqn{\sum_j (n-j+1) X_j}, \eqn{N} the total number of fixings and
+//' \eqn{L} the log-sum of the realized ones. The distribution of \eqn{h(W)}
+//' does not depend on the spot or the strike; it is built once per distinct
+//' \eqn{(n, k)} by an \eqn{O(n^3)} recursion over \eqn{W} and stored with
+//' cumulative sums of \eqn{q} and \eqn{q h}. A quote is then a binary search
+//' over the \eqn{n(n+1)/2 + 1} support points.
+//'
+//' @export
+// [[Rcpp::export]]
+SEXP live_book_create_cpp(
+    Rcpp::NumericVector K, Rcpp::IntegerVector n,
+    std::vector<std::string> option_type,
+    Rcpp::IntegerVector underlying, Rcpp::NumericVector spot,
+    double r, double u, double d,
+    double lambda, double v_u, double v_d,
+    Rcpp::IntegerVector n_fixed, Rcpp::NumericVector fixed_log_sum
+) {
+    int n_options = K.size();
+
+    if ((int)n.size() != n_options || (int)option_type.size() != n_options ||
+        (int)underlying.size() != n_options || (int)n_fixed.size() != n_options ||
+        (int)fixed_log_sum.size() != n_options) {
+        Rcpp::stop("K, n, option_type, underlying, n_fixed and fixed_log_sum must have the same length");
+    }
+
+    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+
+    LiveBook* book = new LiveBook();
+    Rcpp::XPtr<LiveBook> ptr(book, true);
+
+    book->factors = factors;
+    book->r = r;
+
+    book->spot = Rcpp::NumericVector(spot.begin(), spot.end());
+    book->price = Rcpp::NumericVector(n_options);
+    book->delta = Rcpp::NumericVector(n_options);
+    book->by_underlying.resize(spot.size());
+
+    std::map<std::pair<int, int>, int> distribution_index;
+
+    for (int i = 0; i < n_options; ++i) {
+        if (option_type[i] != "call" && option_type[i] != "put") {
+            Rcpp::stop("option_type must be either 'call' or 'put'");
+        }
+        if (n[i] <= 0) {
+            Rcpp::stop("n must be a positive integer");
+        }
+        if (underlying[i] < 1 || underlying[i] > (int)spot.size()) {
+            Rcpp::stop("underlying must index into spot");
+        }
+
+        if (n_fixed[i] < 0) {
+            Rcpp::stop("n_fixed must be non-negative");
+        }
+        if (n_fixed[i] == 0 && fixed_log_sum[i] != 0.0) {
+            Rcpp::stop("fixed_log_sum must be 0 when n_fixed is 0");
+        }
+
+        std::pair<int, int> key(n[i], n_fixed[i]);
+        std::map<std::pair<int, int>, int>::iterator it = distribution_index.find(key);
+        int dist;
+        if (it == distribution_index.end()) {
+            dist = book->distributions.size();
+            book->distributions.push_back(
+                build_geometric_distribution(n[i], factors, n_fixed[i]));
+            distribution_index[key] = dist;
+        } else {
+            dist = it->second;
+        }
+
+        LiveBook::Position pos;
+        pos.distribution = dist;
+        pos.underlying = underlying[i] - 1;
+        pos.K = K[i];
+        pos.log_sum = fixed_log_sum[i];
+        pos.scale = std::exp(fixed_log_sum[i] / (n_fixed[i] + n[i] + 1));
+        pos.discount = std::pow(r, -n[i]);
+        pos.is_call = (option_type[i] == "call");
+        pos.expired = false;
+
+        book->positions.push_back(pos);
+        book->by_underlying[pos.underlying].push_back(i);
+        book->reprice(i);
+    }
+
+    return ptr;
+}
+
+//' Apply Spot Ticks to a Live Book
+//'
+//' Updates the spot of the given underlyings and reprices only the options
+//' written on them. Ticks that leave a spot unchanged are skipped.
+//'
+//' @param book External pointer from \code{\link{live_book_create_cpp}}
+//' @param underlying Indices of the underlyings that ticked (1-based)
+//' @param spot New spot for each entry of \code{underlying}
+//'
+//' @return Number of options repriced
+//'
+//' @export
+// [[Rcpp::export]]
+int live_book_update_cpp(
+    SEXP book, Rcpp::IntegerVector underlying, Rcpp::NumericVector spot
+) {
+    Rcpp::XPtr<LiveBook> ptr(book);
+
+    if (underlying.size() != spot.size()) {
+        Rcpp::stop("underlying and spot must have the same length");
+    }
+
+    int n_underlyings = ptr->spot.size();
+    int repriced = 0;
+
+    for (size_t t = 0; t < (size_t)underlying.size(); ++t) {
+        int idx = underlying[t] - 1;
+        if (idx < 0 || idx >= n_underlyings) {
+            Rcpp::stop("underlying must index into the book's spots");
+        }
+        if (!(spot[t] > 0) || !R_FINITE(spot[t])) {
+            Rcpp::stop("spot must be positive and finite");
+        }
+        if (ptr->spot[idx] == spot[t]) {
+            continue;
+        }
+
+        ptr->spot[idx] = spot[t];
+
+        const std::vector<int>& affected = ptr->by_underlying[idx];
+        for (size_t j = 0; j < affected.size(); ++j) {
+            ptr->reprice(affected[j]);
+        }
+        repriced += affected.size();
+    }
+
+    return repriced;
+}
+
+//' Roll a Live Book Forward One Time Step
+//'
+//' Records the current spot of every underlying as a realized fixing of the
+//' options written on it and advances each shared distribution by one step
+//' in place, without rebuilding it.
+//'
+//' @param book External pointer from \code{\link{live_book_create_cpp}}
+//' @param moves Realized move of each underlying over the step (1 = up,
+//'   0 = down), applied to the spot along the lattice; \code{NA} (or an
+//'   empty vector) leaves the spot for the next tick to set
+//'
+//' @return Number of options still live after the roll
+//'
+//' @details
+//' Rolling turns \eqn{(n, k)} into \eqn{(n-1, k+1)} with the total number of
+//' fixings \eqn{N} unchanged. The step just taken carries the largest
+//' weight \eqn{n} of the weighted up-count, which the recursion adds last,
+//' so the distribution for \eqn{n-1} steps is recomputed from a stored
+//' intermediate layer in \eqn{O(n^{2.5})} instead of \eqn{O(n^3)}, and
+//' layers that include the consumed step are dropped. Options with no steps left are settled at
+//' their payoff on the roll: their price is frozen and their delta set to 0.
+//'
+//' @export
+// [[Rcpp::export]]
+int live_book_roll_cpp(SEXP book, Rcpp::IntegerVector moves) {
+    Rcpp::XPtr<LiveBook> ptr(book);
+
+    int n_underlyings = ptr->spot.size();
+    if (moves.size() != 0 && (int)moves.size() != n_underlyings) {
+        Rcpp::stop("moves must have one entry per underlying");
+    }
+    for (int k = 0; k < (int)moves.size(); ++k) {
+        if (moves[k] != NA_INTEGER && moves[k] != 0 && moves[k] != 1) {
+            Rcpp::stop("moves must be 1 (up), 0 (down) or NA");
+        }
+    }
+
+    std::vector<bool> settling(ptr->distributions.size());
+    for (size_t j = 0; j < ptr->distributions.size(); ++j) {
+        settling[j] = (ptr->distributions[j].n == 0);
+    }
+
+    int live = 0;
+
+    for (size_t i = 0; i < ptr->positions.size(); ++i) {
+        LiveBook::Position& pos = ptr->positions[i];
+        if (pos.expired) {
+            continue;
+        }
+
+        if (settling[pos.distribution]) {
+            // The spot was the last fixing: reprice at it once more and freeze
+            ptr->reprice(i);
+            ptr->delta[i] = 0.0;
+            pos.expired = true;
+            continue;
+        }
+
+        const GeometricDistribution& dist = ptr->distributions[pos.distribution];
+        double N = dist.n_fixed + dist.n + 1;
+
+        pos.log_sum += std::log(ptr->spot[pos.underlying]);
+        pos.scale = std::exp(pos.log_sum / N);
+        pos.discount *= ptr->r;
+        ++live;
+    }
+
+    for (size_t j = 0; j < ptr->distributions.size(); ++j) {
+        if (!settling[j]) {
+            roll_geometric_distribution(ptr->distributions[j], ptr->factors);
+        }
+    }
+
+    for (int k = 0; k < (int)moves.size(); ++k) {
+        if (moves[k] == NA_INTEGER) {
+            continue;
+        }
+        ptr->spot[k] *= moves[k] ? ptr->factors.u_tilde : ptr->factors.d_tilde;
+    }
+
+    for (size_t i = 0; i < ptr->positions.size(); ++i) {
+        ptr->reprice(i);
+    }
+
+    return live;
+}
+
+//' Latest Prices and Deltas of a Live Book
+//'
+//' @param book External pointer from \code{\link{live_book_create_cpp}}
+//'
+//' @return List with \code{price}, \code{delta} (one entry per option) and
+//'   \code{spot} (one entry per underlying), copied from the book so that
+//'   later ticks do not change them and changing them does not corrupt the
+//'   book.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List live_book_state_cpp(SEXP book) {
+    Rcpp::XPtr<LiveBook> ptr(book);
+
+    return Rcpp::List::create(
+        Rcpp::Named("price") = Rcpp::clone(ptr->price),
+        Rcpp::Named("delta") = Rcpp::clone(ptr->delta),
+        Rcpp::Named("spot") = Rcpp::clone(ptr->spot)
+    );
+}
@@ -0,0 +1,461 @@
+#include <Rcpp.h>
+#include "utils.h"
+#include "scratch_arena.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Paths per regression block. Partial sums are formed per block and added
+// in block order, so the estimate does not depend on the thread count.
+static const int LSMC_BLOCK = 4096;
+
+// Highest total degree of the polynomial basis in (S / K, A / K)
+static const int LSMC_MAX_DEGREE = 3;
+static const int LSMC_MAX_BASIS = (LSMC_MAX_DEGREE + 1) * (LSMC_MAX_DEGREE + 2) / 2;
+
+// Simulated paths in column-major order: column t holds step t of every
+// path, so the regression at an exercise date reads contiguous memory
+struct PathBlock {
+    int n_paths;
+    int n_steps;
+    double* S;    // S[t * n_paths + i]
+    double* avg;  // running average of S_0..S_t, same layout
+};
+
+static PathBlock allocate_path_block(int n_paths, int n_steps, ScratchFrame& frame) {
+    PathBlock block;
+    block.n_paths = n_paths;
+    block.n_steps = n_steps;
+    block.S = frame.allocate<double>((size_t)(n_steps + 1) * n_paths);
+    block.avg = frame.allocate<double>((size_t)(n_steps + 1) * n_paths);
+    return block;
+}
+
+// Impacted binomial paths: each step multiplies by u_tilde with
+// probability p_adj and by d_tilde otherwise
+static void fill_binomial_paths(
+    PathBlock& block, double S0, const AdjustedFactors& factors,
+    bool arithmetic
+) {
+    int M = block.n_paths;
+    double log_u = std::log(factors.u_tilde);
+    double log_d = std::log(factors.d_tilde);
+
+    for (int i = 0; i < M; ++i) {
+        double log_S = std::log(S0);
+        double sum = S0;
+        double log_sum = log_S;
+        block.S[i] = S0;
+        block.avg[i] = S0;
+
+        for (int t = 1; t <= block.n_steps; ++t) {
+            log_S += (R::runif(0.0, 1.0) < factors.p_adj) ? log_u : log_d;
+            double S = std::exp(log_S);
+            sum += S;
+            log_sum += log_S;
+
+            size_t idx = (size_t)t * M + i;
+            block.S[idx] = S;
+            block.avg[idx] = arithmetic ? sum / (t + 1) : std::exp(log_sum / (t + 1));
+        }
+    }
+}
+
+// Geometric Brownian motion paths with log-increments drift + vol * Z
+static void fill_gbm_paths(
+    PathBlock& block, double S0, double drift, double vol, bool arithmetic
+) {
+    int M = block.n_paths;
+
+    for (int i = 0; i < M; ++i) {
+        double log_S = std::log(S0);
+        double sum = S0;
+        double log_sum = log_S;
+        block.S[i] = S0;
+        block.avg[i] = S0;
+
+        for (int t = 1; t <= block.n_steps; ++t) {
+            log_S += drift + vol * R::rnorm(0.0, 1.0);
+            double S = std::exp(log_S);
+            sum += S;
+            log_sum += log_S;
+
+            size_t idx = (size_t)t * M + i;
+            block.S[idx] = S;
+            block.avg[idx] = arithmetic ? sum / (t + 1) : std::exp(log_sum / (t + 1));
+        }
+    }
+}
+
+// Monomials x^a y^b with a + b <= degree
+static inline void evaluate_basis(double x, double y, int degree, double* phi) {
+    int j = 0;
+    double x_pow = 1.0;
+    for (int a = 0; a <= degree; ++a) {
+        double term = x_pow;
+        for (int b = 0; a + b <= degree; ++b) {
+            phi[j++] = term;
+            term *= y;
+        }
+        x_pow *= x;
+    }
+}
+
+// Solves the symmetric system A beta = b in place by Gaussian elimination
+// with partial pivoting. Returns false if A is numerically singular.
+static bool solve_normal_equations(double* A, double* b, int p, double* beta) {
+    double scale = 0.0;
+    for (int j = 0; j < p; ++j) {
+        scale = std::max(scale, std::fabs(A[j * p + j]));
+    }
+
+    for (int col = 0; col < p; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < p; ++row) {
+            if (std::fabs(A[row * p + col]) > std::fabs(A[pivot * p + col])) {
+                pivot = row;
+            }
+        }
+        if (std::fabs(A[pivot * p + col]) <= 1e-13 * scale) {
+            return false;
+        }
+        if (pivot != col) {
+            for (int j = 0; j < p; ++j) {
+                std::swap(A[col * p + j], A[pivot * p + j]);
+            }
+            std::swap(b[col], b[pivot]);
+        }
+        for (int row = col + 1; row < p; ++row) {
+            double factor = A[row * p + col] / A[col * p + col];
+            for (int j = col; j < p; ++j) {
+                A[row * p + j] -= factor * A[col * p + j];
+            }
+            b[row] -= factor * b[col];
+        }
+    }
+
+    for (int row = p - 1; row >= 0; --row) {
+        double sum = b[row];
+        for (int j = row + 1; j < p; ++j) {
+            sum -= A[row * p + j] * beta[j];
+        }
+        beta[row] = sum / A[row * p + row];
+    }
+
+    return true;
+}
+
+static inline double exercise_value(double avg, double K, bool is_call) {
+    return is_call ? std::max(0.0, avg - K) : std::max(0.0, K - avg);
+}
+
+struct LsmcResult {
+    double price;
+    double std_error;
+    double european_price;
+    double early_exercise_fraction;
+};
+
+// Longstaff-Schwartz backward pass. value[i] holds the cash flow of path i
+// discounted to the current date; at each exercise date the in-the-money
+// continuation values are regressed on the basis and paths whose exercise
+// value beats the fitted continuation exercise there.
+static LsmcResult lsmc_backward(
+    const PathBlock& block, double K, bool is_call, double step_discount,
+    const std::vector<bool>& exercisable, int degree, int n_threads
+) {
+    int M = block.n_paths;
+    int n = block.n_steps;
+    int p = (degree + 1) * (degree + 2) / 2;
+    int n_blocks = (M + LSMC_BLOCK - 1) / LSMC_BLOCK;
+    int stride = p * p + p + 1;
+
+    ScratchFrame frame;
+    double* value = frame.allocate<double>(M);
+    unsigned char* exercised = frame.allocate<unsigned char>(M);
+    double* partial = frame.allocate<double>((size_t)n_blocks * stride);
+
+    const double* avg_n = block.avg + (size_t)n * M;
+    double terminal_sum = 0.0;
+    for (int i = 0; i < M; ++i) {
+        value[i] = exercise_value(avg_n[i], K, is_call);
+        exercised[i] = 0;
+        terminal_sum += value[i];
+    }
+
+    for (int t = n - 1; t >= 1; --t) {
+        for (int i = 0; i < M; ++i) {
+            value[i] *= step_discount;
+        }
+        if (!exercisable[t]) {
+            continue;
+        }
+
+        const double* S_t = block.S + (size_t)t * M;
+        const double* avg_t = block.avg + (size_t)t * M;
+
+        #pragma omp parallel for num_threads(n_threads) schedule(static)
+        for (int blk = 0; blk < n_blocks; ++blk) {
+            double* XtX = partial + (size_t)blk * stride;
+            double* Xty = XtX + p * p;
+            double* count = Xty + p;
+            std::fill(XtX, XtX + stride, 0.0);
+
+            double phi[LSMC_MAX_BASIS];
+            int end = std::min(M, (blk + 1) * LSMC_BLOCK);
+            for (int i = blk * LSMC_BLOCK; i < end; ++i) {
+                if (exercise_value(avg_t[i], K, is_call) <= 0.0) {
+                    continue;
+                }
+                evaluate_basis(S_t[i] / K, avg_t[i] / K, degree, phi);
+                for (int a = 0; a < p; ++a) {
+                    for (int b = a; b < p; ++b) {
+                        XtX[a * p + b] += phi[a] * phi[b];
+                    }
+                    Xty[a] += phi[a] * value[i];
+                }
+                *count += 1.0;
+            }
+        }
+
+        double A[LSMC_MAX_BASIS * LSMC_MAX_BASIS];
+        double rhs[LSMC_MAX_BASIS];
+        double beta[LSMC_MAX_BASIS];
+        std::fill(A, A + p * p, 0.0);
+        std::fill(rhs, rhs + p, 0.0);
+        double in_the_money = 0.0;
+
+        for (int blk = 0; blk < n_blocks; ++blk) {
+            const double* XtX = partial + (size_t)blk * stride;
+            for (int j = 0; j < p * p; ++j) {
+                A[j] += XtX[j];
+            }
+            for (int j = 0; j < p; ++j) {
+                rhs[j] += XtX[p * p + j];
+            }
+            in_the_money += XtX[p * p + p];
+        }
+        for (int a = 0; a < p; ++a) {
+            for (int b = 0; b < a; ++b) {
+                A[a * p + b] = A[b * p + a];
+            }
+        }
+
+        if (in_the_money < p || !solve_normal_equations(A, rhs, p, beta)) {
+            continue;
+        }
+
+        #pragma omp parallel for num_threads(n_threads) schedule(static)
+        for (int i = 0; i < M; ++i) {
+            double payoff = exercise_value(avg_t[i], K, is_call);
+            if (payoff <= 0.0) {
+                continue;
+            }
+            double phi[LSMC_MAX_BASIS];
+            evaluate_basis(S_t[i] / K, avg_t[i] / K, degree, phi);
+            double continuation = 0.0;
+            for (int j = 0; j < p; ++j) {
+                continuation += beta[j] * phi[j];
+            }
+            if (payoff > continuation) {
+                value[i] = payoff;
+                exercised[i] = 1;
+            }
+        }
+    }
+
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    int early = 0;
+    for (int i = 0; i < M; ++i) {
+        double v = value[i] * step_discount;
+        sum += v;
+        sum_sq += v * v;
+        early += exercised[i];
+    }
+
+    LsmcResult result;
+    result.price = sum / M;
+    double variance = sum_sq / M - result.price * result.price;
+    result.std_error = std::sqrt(std::max(0.0, variance) / M);
+    result.european_price = std::pow(step_discount, n) * terminal_sum / M;
+    result.early_exercise_fraction = (double)early / M;
+    return result;
+}
+
+// Validates the shared arguments and marks the exercise steps
+static std::vector<bool> lsmc_schedule(
+    int n, int n_paths, const std::string& option_type,
+    const std::string& average, Rcpp::IntegerVector exercise, int degree,
+    int n_threads
+) {
+    if (n <= 0) {
+        Rcpp::stop("n must be a positive integer");
+    }
+    if (n_paths <= 0) {
+        Rcpp::stop("n_paths must be a positive integer");
+    }
+    if (option_type != "call" && option_type != "put") {
+        Rcpp::stop("option_type must be either 'call' or 'put'");
+    }
+    if (average != "arithmetic" && average != "geometric") {
+        Rcpp::stop("average must be either 'arithmetic' or 'geometric'");
+    }
+    if (degree < 1 || degree > LSMC_MAX_DEGREE) {
+        Rcpp::stop("degree must be between 1 and 3");
+    }
+    if (n_threads < 1) {
+        Rcpp::stop("n_threads must be a positive integer");
+    }
+
+    return exercise_schedule(n, exercise);
+}
+
+static Rcpp::List lsmc_result_list(const LsmcResult& result, int n_paths, int n) {
+    return Rcpp::List::create(
+        Rcpp::Named("price") = result.price,
+        Rcpp::Named("std_error") = result.std_error,
+        Rcpp::Named("european_price") = result.european_price,
+        Rcpp::Named("early_exercise_premium") = result.price - result.european_price,
+        Rcpp::Named("early_exercise_fraction") = result.early_exercise_fraction,
+        Rcpp::Named("n_paths") = n_paths,
+        Rcpp::Named("n_steps") = n
+    );
+}
+
+//' Longstaff-Schwartz Price of an American/Bermudan Asian Option with Price Impact
+//'
+//' Prices an Asian option that may be exercised early for its running
+//' average, on paths of the impacted binomial tree.
+//'
+//' @param S0 Initial stock price
+//' @param K Strike price
+//' @param r Gross risk-free rate per period
+//' @param u Base up factor in CRR model
+//' @param d Base down factor in CRR model
+//' @param lambda Price impact coefficient (non-negative)
+//' @param v_u Hedging volume on up move (non-negative)
+//' @param v_d Hedging volume on down move (non-negative)
+//' @param n Number of time steps
+//' @param exercise Steps (in 1..n) at which exercise is allowed; maturity is
+//'   always included and an empty vector allows every step
+//' @param n_paths Number of simulated paths
+//' @param option_type "call" or "put"
+//' @param average "arithmetic" or "geometric" running average
+//' @param degree Total degree (1 to 3) of the polynomial basis
+//' @param seed Random seed (negative for none)
+//' @param n_threads Threads for the backward pass
+//'
+//' @return List with \code{price}, \code{std_error}, \code{european_price},
+//'   \code{early_exercise_premium}, \code{early_exercise_fraction},
+//'   \code{n_paths} and \code{n_steps}
+//'
+//' @details
+//' Exercising at step \eqn{t} pays \eqn{\max(0, A_t - K)} (call) or
+//' \eqn{\max(0, K - A_t)} (put), with \eqn{A_t} the average of
+//' \eqn{S_0, \ldots, S_t}. At each exercise date the discounted future cash
+//' flows of the in-the-money paths are regressed on the monomials
+//' \eqn{(S_t/K)^a (A_t/K)^b}, \eqn{a + b \le} \code{degree}, and a path
+//' exercises when its payoff exceeds the fitted continuation value.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List price_asian_lsmc_cpp(
+    double S0, double K, double r, double u, double d,
+    double lambda, double v_u, double v_d, int n,
+    Rcpp::IntegerVector exercise,
+    int n_paths = 100000,
+    std::string option_type = "call",
+    std::string average = "arithmetic",
+    int degree = 2,
+    int seed = -1,
+    int n_threads = 1
+) {
+    std::vector<bool> exercisable = lsmc_schedule(
+        n, n_paths, option_type, average, exercise, degree, n_threads);
+
+    if (seed >= 0) {
+        Rcpp::Environment base_env("package:base");
+        Rcpp::Function set_seed = base_env["set.seed"];
+        set_seed(seed);
+    }
+
+    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+
+    ScratchFrame frame;
+    PathBlock block = allocate_path_block(n_paths, n, frame);
+
+    GetRNGstate();
+    fill_binomial_paths(block, S0, factors, average == "arithmetic");
+    PutRNGstate();
+
+    LsmcResult result = lsmc_backward(block, K, option_type == "call", 1.0 / r,
+                                      exercisable, degree, n_threads);
+
+    return lsmc_result_list(result, n_paths, n);
+}
+
+//' Longstaff-Schwartz Price of an American/Bermudan Asian Option (Black-Scholes)
+//'
+//' Same engine as \code{\link{price_asian_lsmc_cpp}} on the lognormal paths
+//' of the Kemna-Vorst simulator, without price impact.
+//'
+//' @param S0 Initial stock price
+//' @param K Strike price
+//' @param r Continuously compounded risk-free rate
+//' @param sigma Volatility (annualized)
+//' @param T Maturity time
+//' @param n Number of time steps
+//' @param exercise Steps (in 1..n) at which exercise is allowed; maturity is
+//'   always included and an empty vector allows every step
+//' @param n_paths Number of simulated paths
+//' @param option_type "call" or "put"
+//' @param average "arithmetic" or "geometric" running average
+//' @param degree Total degree (1 to 3) of the polynomial basis
+//' @param seed Random seed (negative for none)
+//' @param n_threads Threads for the backward pass
+//'
+//' @return List as in \code{\link{price_asian_lsmc_cpp}}
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List price_kemna_vorst_lsmc_cpp(
+    double S0, double K, double r, double sigma, double T, int n,
+    Rcpp::IntegerVector exercise,
+    int n_paths = 100000,
+    std::string option_type = "call",
+    std::string average = "arithmetic",
+    int degree = 2,
+    int seed = -1,
+    int n_threads = 1
+) {
+    std::vector<bool> exercisable = lsmc_schedule(
+        n, n_paths, option_type, average, exercise, degree, n_threads);
+
+    if (seed >= 0) {
+        Rcpp::Environment base_env("package:base");
+        Rcpp::Function set_seed = base_env["set.seed"];
+        set_seed(seed);
+    }
+
+    double dt = T / n;
+    double drift = (r - 0.5 * sigma * sigma) * dt;
+    double vol = sigma * std::sqrt(dt);
+
+    ScratchFrame frame;
+    PathBlock block = allocate_path_block(n_paths, n, frame);
+
+    GetRNGstate();
+    fill_gbm_paths(block, S0, drift, vol, average == "arithmetic");
+    PutRNGstate();
+
+    LsmcResult result = lsmc_backward(block, K, option_type == "call",
+                                      std::exp(-r * dt), exercisable, degree,
+                                      n_threads);
+
+    return lsmc_result_list(result, n_paths, n);
+}
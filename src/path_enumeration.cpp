@@ -0,0 +1,616 @@
+#include "path_enumeration.h"
+#include "path_kernel.h"
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+
+// Builds the table by doubling one step at a time: entry i of a block of
+// j steps spawns a down move at i and an up move at i + 2^j
+PathTable build_path_table(int steps, const AdjustedFactors& factors,
+                           ScratchFrame& frame) {
+    PathTable table;
+    table.steps = steps;
+
+    size_t total = (size_t)1 << steps;
+    table.count = total;
+    table.rel_log_sum = frame.allocate<double>(total);
+    table.rel_sum = frame.allocate<double>(total);
+    table.rel_min = frame.allocate<double>(total);
+    table.rel_max = frame.allocate<double>(total);
+    table.rel_end = frame.allocate<double>(total);
+    table.prob = frame.allocate<double>(total);
+
+    table.rel_log_sum[0] = 0.0;
+    table.rel_sum[0] = 0.0;
+    table.rel_min[0] = 1.0;
+    table.rel_max[0] = 1.0;
+    table.rel_end[0] = 1.0;
+    table.prob[0] = 1.0;
+
+    double log_u = std::log(factors.u_tilde);
+    double log_d = std::log(factors.d_tilde);
+    double q = 1.0 - factors.p_adj;
+
+    for (int j = 0; j < steps; ++j) {
+        size_t count = (size_t)1 << j;
+
+        for (size_t i = 0; i < count; ++i) {
+            double end = table.rel_end[i];
+            double log_end = std::log(end);
+
+            size_t up = count + i;
+            double end_up = end * factors.u_tilde;
+            table.rel_end[up] = end_up;
+            table.rel_sum[up] = table.rel_sum[i] + end_up;
+            table.rel_log_sum[up] = table.rel_log_sum[i] + log_end + log_u;
+            table.rel_min[up] = table.rel_min[i];
+            table.rel_max[up] = std::max(table.rel_max[i], end_up);
+            table.prob[up] = table.prob[i] * factors.p_adj;
+
+            double end_down = end * factors.d_tilde;
+            table.rel_end[i] = end_down;
+            table.rel_sum[i] += end_down;
+            table.rel_log_sum[i] += log_end + log_d;
+            table.rel_min[i] = std::min(table.rel_min[i], end_down);
+            table.prob[i] *= q;
+        }
+    }
+
+    return table;
+}
+
+// A path of n steps is a prefix of n - b steps followed by a suffix of
+// b = min(n, SUFFIX_BLOCK_STEPS) steps. With S_m the prefix endpoint:
+//   sum_i log S_i = [(m+1) log S0 + prefix log-sum + b log S_m] + suffix log-sum
+// so G = C(prefix) * g(suffix), and each prefix is a single sweep over the
+// contiguous suffix table. Realized fixings add their log-sum to C and their
+// count to the number of averaged prices N.
+GeometricSums sum_geometric_payoffs(
+    double S0, double K, int n,
+    const AdjustedFactors& factors,
+    bool is_call,
+    const Seasoning& seasoning,
+    DistributionSketch* payoff_sketch,
+    DistributionSketch* average_sketch
+) {
+    int b = std::min(n, SUFFIX_BLOCK_STEPS);
+    int m = n - b;
+    double N = seasoning.count + n + 1;
+    bool sketching = payoff_sketch != NULL || average_sketch != NULL;
+
+    ScratchFrame frame;
+    PathTable prefix = build_path_table(m, factors, frame);
+    PathTable suffix = build_path_table(b, factors, frame);
+
+    size_t n_suffix = suffix.size();
+    double* g = frame.allocate<double>(n_suffix);
+    double suffix_qg = 0.0;
+
+    for (size_t j = 0; j < n_suffix; ++j) {
+        g[j] = std::exp(suffix.rel_log_sum[j] / N);
+        suffix_qg += suffix.prob[j] * g[j];
+    }
+
+    const double* g_ptr = g;
+    const double* q_ptr = suffix.prob;
+    double log_S0 = std::log(S0);
+
+    GeometricSums sums = {0.0, 0.0};
+
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        double log_S_m = log_S0 + std::log(prefix.rel_end[i]);
+        double C = std::exp((seasoning.log_sum + (m + 1) * log_S0 +
+                             prefix.rel_log_sum[i] + b * log_S_m) / N);
+
+        double payoff_sum = 0.0;
+        if (sketching) {
+            // Kept apart so that the plain sweeps below stay branch-free
+            for (size_t j = 0; j < n_suffix; ++j) {
+                double G = C * g_ptr[j];
+                double payoff = is_call ? std::max(0.0, G - K) : std::max(0.0, K - G);
+                double weight = prefix.prob[i] * q_ptr[j];
+                payoff_sum += q_ptr[j] * payoff;
+                if (payoff_sketch != NULL) {
+                    payoff_sketch->add(payoff, weight);
+                }
+                if (average_sketch != NULL) {
+                    average_sketch->add(G, weight);
+                }
+            }
+        } else if (is_call) {
+            for (size_t j = 0; j < n_suffix; ++j) {
+                payoff_sum += q_ptr[j] * std::max(0.0, C * g_ptr[j] - K);
+            }
+        } else {
+            for (size_t j = 0; j < n_suffix; ++j) {
+                payoff_sum += q_ptr[j] * std::max(0.0, K - C * g_ptr[j]);
+            }
+        }
+
+        sums.payoff += prefix.prob[i] * payoff_sum;
+        sums.G += prefix.prob[i] * C * suffix_qg;
+    }
+
+    return sums;
+}
+
+double sum_arithmetic_path_payoffs(
+    double S0, double K, int n,
+    const AdjustedFactors& factors,
+    bool is_call,
+    const Seasoning& seasoning,
+    DistributionSketch* payoff_sketch,
+    DistributionSketch* average_sketch
+) {
+    int b = std::min(n, SUFFIX_BLOCK_STEPS);
+    int m = n - b;
+    double N = seasoning.count + n + 1;
+
+    ScratchFrame frame;
+    PathTable prefix = build_path_table(m, factors, frame);
+    PathTable suffix = build_path_table(b, factors, frame);
+
+    size_t n_suffix = suffix.size();
+    double total = 0.0;
+
+    // sum_i S_i = seasoning + S0 (1 + prefix rel_sum) + S_m * suffix rel_sum
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        double P = seasoning.sum + S0 * (1.0 + prefix.rel_sum[i]);
+        double S_m = S0 * prefix.rel_end[i];
+
+        double payoff_sum = 0.0;
+        for (size_t j = 0; j < n_suffix; ++j) {
+            double A = (P + S_m * suffix.rel_sum[j]) / N;
+            double payoff = is_call ? std::max(0.0, A - K) : std::max(0.0, K - A);
+            double weight = prefix.prob[i] * suffix.prob[j];
+            payoff_sum += suffix.prob[j] * payoff;
+            if (payoff_sketch != NULL) {
+                payoff_sketch->add(payoff, weight);
+            }
+            if (average_sketch != NULL) {
+                average_sketch->add(A, weight);
+            }
+        }
+
+        total += prefix.prob[i] * payoff_sum;
+    }
+
+    return total;
+}
+
+SimulatedSums simulate_asian_payoffs(
+    double S0, double K, int n,
+    const AdjustedFactors& factors,
+    bool is_call, bool arithmetic,
+    const Seasoning& seasoning,
+    int n_simulations, double discount,
+    DistributionSketch* payoff_sketch,
+    DistributionSketch* average_sketch
+) {
+    double N = seasoning.count + n + 1;
+
+    ScratchFrame frame;
+    unsigned char* moves = frame.allocate<unsigned char>((size_t)n * PATH_LANES);
+    std::fill(moves, moves + (size_t)n * PATH_LANES, 0);
+    PathLanes lanes;
+
+    SimulatedSums sums = {0.0, 0.0};
+
+    for (int first = 0; first < n_simulations; first += PATH_LANES) {
+        int count = std::min(PATH_LANES, n_simulations - first);
+
+        for (int l = 0; l < count; ++l) {
+            for (int i = 0; i < n; ++i) {
+                moves[(size_t)i * PATH_LANES + l] =
+                    (R::runif(0.0, 1.0) < factors.p_adj) ? 1 : 0;
+            }
+        }
+
+        evaluate_path_lanes(moves, n, S0, factors, lanes);
+
+        for (int l = 0; l < count; ++l) {
+            double average;
+            if (arithmetic) {
+                average = (seasoning.sum + (n + 1) * lanes.A[l]) / N;
+            } else {
+                average = lanes.G[l];
+                if (seasoning.count > 0) {
+                    average = std::exp((seasoning.log_sum + (n + 1) * std::log(average)) / N);
+                }
+            }
+
+            double payoff;
+            if (is_call) {
+                payoff = std::max(0.0, average - K);
+            } else {
+                payoff = std::max(0.0, K - average);
+            }
+
+            if (payoff_sketch != NULL) {
+                payoff_sketch->add(payoff, 1.0);
+            }
+            if (average_sketch != NULL) {
+                average_sketch->add(average, 1.0);
+            }
+
+            payoff *= discount;
+            sums.sum += payoff;
+            sums.sum_sq += payoff * payoff;
+        }
+    }
+
+    return sums;
+}
+
+// For a prefix with price sum P and endpoint S_m the payoff is monotone in
+// the suffix relative sum R, so the exercise region is found by one binary
+// search for R* = (strike_sum - P) / S_m. Returns the prefix's undiscounted
+// contribution, weighted by its probability.
+static inline double arithmetic_prefix_payoff(
+    const ArithmeticTables& tables, size_t i,
+    double S0, double strike_sum, bool is_call
+) {
+    const double* sorted_rel = tables.sorted_rel;
+    size_t n_suffix = tables.n_suffix;
+
+    double P = S0 * (1.0 + tables.prefix_rel_sum[i]);
+    double S_m = S0 * tables.prefix_rel_end[i];
+
+    double threshold = (strike_sum - P) / S_m;
+
+    double contribution;
+    if (is_call) {
+        size_t idx = std::upper_bound(sorted_rel, sorted_rel + n_suffix,
+                                      threshold) - sorted_rel;
+        double q_above = tables.cum_q[n_suffix] - tables.cum_q[idx];
+        double qr_above = tables.cum_qr[n_suffix] - tables.cum_qr[idx];
+        contribution = S_m * qr_above + (P - strike_sum) * q_above;
+    } else {
+        size_t idx = std::lower_bound(sorted_rel, sorted_rel + n_suffix,
+                                      threshold) - sorted_rel;
+        contribution = (strike_sum - P) * tables.cum_q[idx] -
+                       S_m * tables.cum_qr[idx];
+    }
+
+    return tables.prefix_prob[i] * std::max(0.0, contribution);
+}
+
+void sum_two_sided_payoffs(
+    double S0, double K, int n,
+    const AdjustedFactors factors[2],
+    bool is_call, bool arithmetic,
+    const Seasoning& seasoning,
+    double expected[2]
+) {
+    double N = seasoning.count + n + 1;
+
+    if (arithmetic) {
+        // Meet in the middle as in sum_arithmetic_payoffs: prefixes are
+        // indexed by their moves on both sides, so one sweep serves both
+        ScratchFrame frame;
+        ArithmeticTables tables[2];
+        for (int side = 0; side < 2; ++side) {
+            tables[side] = build_arithmetic_tables(n, factors[side], frame);
+        }
+
+        double strike_sum = N * K - seasoning.sum;
+        double total[2] = {0.0, 0.0};
+        for (size_t i = 0; i < tables[0].n_prefix; ++i) {
+            total[0] += arithmetic_prefix_payoff(tables[0], i, S0, strike_sum, is_call);
+            total[1] += arithmetic_prefix_payoff(tables[1], i, S0, strike_sum, is_call);
+        }
+
+        expected[0] = total[0] / N;
+        expected[1] = total[1] / N;
+        return;
+    }
+
+    int b = std::min(n, SUFFIX_BLOCK_STEPS);
+    int m = n - b;
+    double log_S0 = std::log(S0);
+
+    ScratchFrame frame;
+    PathTable prefix[2];
+    PathTable suffix[2];
+    double* g[2];
+    for (int side = 0; side < 2; ++side) {
+        prefix[side] = build_path_table(m, factors[side], frame);
+        suffix[side] = build_path_table(b, factors[side], frame);
+        // Suffix geometric factors
+        g[side] = frame.allocate<double>(suffix[side].size());
+        for (size_t j = 0; j < suffix[side].size(); ++j) {
+            g[side][j] = std::exp(suffix[side].rel_log_sum[j] / N);
+        }
+    }
+
+    size_t n_suffix = suffix[0].size();
+    expected[0] = 0.0;
+    expected[1] = 0.0;
+
+    for (size_t i = 0; i < prefix[0].size(); ++i) {
+        // Per side: the geometric average is C * g[j] over the suffixes
+        double C[2];
+        for (int side = 0; side < 2; ++side) {
+            const PathTable& pre = prefix[side];
+            double S_m = S0 * pre.rel_end[i];
+            C[side] = std::exp((seasoning.log_sum + (m + 1) * log_S0 +
+                                pre.rel_log_sum[i] + b * std::log(S_m)) / N);
+        }
+
+        const double* q0 = suffix[0].prob;
+        const double* q1 = suffix[1].prob;
+        double payoff_sum[2] = {0.0, 0.0};
+        if (is_call) {
+            for (size_t j = 0; j < n_suffix; ++j) {
+                payoff_sum[0] += q0[j] * std::max(0.0, C[0] * g[0][j] - K);
+                payoff_sum[1] += q1[j] * std::max(0.0, C[1] * g[1][j] - K);
+            }
+        } else {
+            for (size_t j = 0; j < n_suffix; ++j) {
+                payoff_sum[0] += q0[j] * std::max(0.0, K - C[0] * g[0][j]);
+                payoff_sum[1] += q1[j] * std::max(0.0, K - C[1] * g[1][j]);
+            }
+        }
+
+        expected[0] += prefix[0].prob[i] * payoff_sum[0];
+        expected[1] += prefix[1].prob[i] * payoff_sum[1];
+    }
+}
+
+TwoSidedSums simulate_two_sided_payoffs(
+    double S0, double K, int n,
+    const AdjustedFactors factors[2],
+    bool is_call, bool arithmetic,
+    const Seasoning& seasoning,
+    int n_simulations, double discount
+) {
+    double N = seasoning.count + n + 1;
+
+    ScratchFrame frame;
+    unsigned char* moves[2];
+    for (int side = 0; side < 2; ++side) {
+        moves[side] = frame.allocate<unsigned char>((size_t)n * PATH_LANES);
+        std::fill(moves[side], moves[side] + (size_t)n * PATH_LANES, 0);
+    }
+    PathLanes lanes[2];
+
+    TwoSidedSums sums = {{0.0, 0.0}, {0.0, 0.0}, 0.0, 0.0};
+
+    for (int first = 0; first < n_simulations; first += PATH_LANES) {
+        int count = std::min(PATH_LANES, n_simulations - first);
+
+        for (int l = 0; l < count; ++l) {
+            for (int i = 0; i < n; ++i) {
+                double U = R::runif(0.0, 1.0);
+                size_t at = (size_t)i * PATH_LANES + l;
+                moves[0][at] = (U < factors[0].p_adj) ? 1 : 0;
+                moves[1][at] = (U < factors[1].p_adj) ? 1 : 0;
+            }
+        }
+
+        evaluate_path_lanes(moves[0], n, S0, factors[0], lanes[0]);
+        evaluate_path_lanes(moves[1], n, S0, factors[1], lanes[1]);
+
+        for (int l = 0; l < count; ++l) {
+            double payoff[2];
+            for (int side = 0; side < 2; ++side) {
+                double average;
+                if (arithmetic) {
+                    average = (seasoning.sum + (n + 1) * lanes[side].A[l]) / N;
+                } else {
+                    average = lanes[side].G[l];
+                    if (seasoning.count > 0) {
+                        average = std::exp((seasoning.log_sum +
+                                            (n + 1) * std::log(average)) / N);
+                    }
+                }
+                payoff[side] = discount * (is_call ? std::max(0.0, average - K)
+                                                   : std::max(0.0, K - average));
+                sums.sum[side] += payoff[side];
+                sums.sum_sq[side] += payoff[side] * payoff[side];
+            }
+
+            double diff = payoff[1] - payoff[0];
+            sums.diff_sum += diff;
+            sums.diff_sum_sq += diff * diff;
+        }
+    }
+
+    return sums;
+}
+
+void evaluate_path_field(const PathFieldSpec& spec, long long first,
+                         long long count, double* out) {
+    int n = spec.n;
+    const Seasoning& seasoning = spec.seasoning;
+    double N = seasoning.count + n + 1;
+    double log_S0 = std::log(spec.S0);
+    double log_u = std::log(spec.factors.u_tilde);
+    double log_d = std::log(spec.factors.d_tilde);
+    double log_p = std::log(spec.factors.p_adj);
+    double log_q = std::log(1.0 - spec.factors.p_adj);
+
+    for (long long i = 0; i < count; ++i) {
+        unsigned long long path = (unsigned long long)(first + i);
+
+        double value;
+        if (spec.field == PATH_FIELD_PROB) {
+            int k = 0;
+            for (int j = 0; j < n; ++j) {
+                k += (int)((path >> j) & 1);
+            }
+            value = std::exp(k * log_p + (n - k) * log_q);
+        } else {
+            double log_S = log_S0;
+            double log_sum = log_S0;
+            double sum = spec.S0;
+            double S_min = spec.S0;
+            double S_max = spec.S0;
+
+            for (int j = 0; j < n; ++j) {
+                log_S += ((path >> j) & 1) ? log_u : log_d;
+                double S = std::exp(log_S);
+                log_sum += log_S;
+                sum += S;
+                S_min = std::min(S_min, S);
+                S_max = std::max(S_max, S);
+            }
+
+            if (spec.field == PATH_FIELD_G) {
+                value = std::exp((seasoning.log_sum + log_sum) / N);
+            } else if (spec.field == PATH_FIELD_A) {
+                value = (seasoning.sum + sum) / N;
+            } else {
+                if (seasoning.count > 0) {
+                    S_min = std::min(S_min, seasoning.min);
+                    S_max = std::max(S_max, seasoning.max);
+                }
+                value = std::exp((S_max - S_min) * (S_max - S_min) /
+                                 (4.0 * S_min * S_max));
+            }
+        }
+
+        out[i] = value;
+    }
+}
+
+double sum_path_specific_spread(
+    double S0, int n,
+    const AdjustedFactors& factors,
+    const Seasoning& seasoning
+) {
+    int b = std::min(n, SUFFIX_BLOCK_STEPS);
+    int m = n - b;
+    double N = seasoning.count + n + 1;
+    bool seasoned = seasoning.count > 0;
+
+    ScratchFrame frame;
+    PathTable prefix = build_path_table(m, factors, frame);
+    PathTable suffix = build_path_table(b, factors, frame);
+
+    size_t n_suffix = suffix.size();
+    double* qg = frame.allocate<double>(n_suffix);
+
+    for (size_t j = 0; j < n_suffix; ++j) {
+        qg[j] = suffix.prob[j] * std::exp(suffix.rel_log_sum[j] / N);
+    }
+
+    double log_S0 = std::log(S0);
+    double total = 0.0;
+
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        double S_m = S0 * prefix.rel_end[i];
+        double C = std::exp((seasoning.log_sum + (m + 1) * log_S0 +
+                             prefix.rel_log_sum[i] + b * std::log(S_m)) / N);
+        double prefix_min = S0 * prefix.rel_min[i];
+        double prefix_max = S0 * prefix.rel_max[i];
+
+        if (seasoned) {
+            prefix_min = std::min(prefix_min, seasoning.min);
+            prefix_max = std::max(prefix_max, seasoning.max);
+        }
+
+        double spread_sum = 0.0;
+        for (size_t j = 0; j < n_suffix; ++j) {
+            double S_min = std::min(prefix_min, S_m * suffix.rel_min[j]);
+            double S_max = std::max(prefix_max, S_m * suffix.rel_max[j]);
+            double spread = (S_max - S_min) * (S_max - S_min) /
+                            (4.0 * S_min * S_max);
+            spread_sum += qg[j] * (std::exp(spread) - 1.0);
+        }
+
+        total += prefix.prob[i] * C * spread_sum;
+    }
+
+    return total;
+}
+
+ArithmeticTables build_arithmetic_tables(int n, const AdjustedFactors& factors,
+                                         ScratchFrame& frame) {
+    int m = n / 2;
+    PathTable prefix = build_path_table(m, factors, frame);
+    PathTable suffix = build_path_table(n - m, factors, frame);
+
+    size_t n_suffix = suffix.size();
+
+    // The sort order is only needed here; it is allocated after the tables
+    // so that the frame's later allocations can reuse the space
+    double* sorted_rel = frame.allocate<double>(n_suffix);
+    double* cum_q = frame.allocate<double>(n_suffix + 1);
+    double* cum_qr = frame.allocate<double>(n_suffix + 1);
+
+    ScratchFrame order_frame;
+    size_t* order = order_frame.allocate<size_t>(n_suffix);
+    std::iota(order, order + n_suffix, (size_t)0);
+    std::sort(order, order + n_suffix, [&](size_t a, size_t b) {
+        return suffix.rel_sum[a] < suffix.rel_sum[b];
+    });
+
+    cum_q[0] = 0.0;
+    cum_qr[0] = 0.0;
+    for (size_t i = 0; i < n_suffix; ++i) {
+        size_t idx = order[i];
+        sorted_rel[i] = suffix.rel_sum[idx];
+        cum_q[i + 1] = cum_q[i] + suffix.prob[idx];
+        cum_qr[i + 1] = cum_qr[i] + suffix.prob[idx] * suffix.rel_sum[idx];
+    }
+
+    ArithmeticTables tables;
+    tables.n = n;
+    tables.n_prefix = prefix.size();
+    tables.n_suffix = n_suffix;
+    tables.prefix_rel_sum = prefix.rel_sum;
+    tables.prefix_rel_end = prefix.rel_end;
+    tables.prefix_prob = prefix.prob;
+    tables.sorted_rel = sorted_rel;
+    tables.cum_q = cum_q;
+    tables.cum_qr = cum_qr;
+    return tables;
+}
+
+StoredArithmeticTables store_arithmetic_tables(const ArithmeticTables& tables) {
+    StoredArithmeticTables stored;
+    stored.n = tables.n;
+    stored.n_prefix = tables.n_prefix;
+    stored.n_suffix = tables.n_suffix;
+
+    size_t np = tables.n_prefix;
+    size_t ns = tables.n_suffix;
+    stored.data.reserve(3 * np + 3 * ns + 2);
+    stored.data.insert(stored.data.end(), tables.prefix_rel_sum, tables.prefix_rel_sum + np);
+    stored.data.insert(stored.data.end(), tables.prefix_rel_end, tables.prefix_rel_end + np);
+    stored.data.insert(stored.data.end(), tables.prefix_prob, tables.prefix_prob + np);
+    stored.data.insert(stored.data.end(), tables.sorted_rel, tables.sorted_rel + ns);
+    stored.data.insert(stored.data.end(), tables.cum_q, tables.cum_q + ns + 1);
+    stored.data.insert(stored.data.end(), tables.cum_qr, tables.cum_qr + ns + 1);
+    return stored;
+}
+
+ArithmeticTables StoredArithmeticTables::view() const {
+    const double* base = data.data();
+
+    ArithmeticTables tables;
+    tables.n = n;
+    tables.n_prefix = n_prefix;
+    tables.n_suffix = n_suffix;
+    tables.prefix_rel_sum = base;
+    tables.prefix_rel_end = base + n_prefix;
+    tables.prefix_prob = base + 2 * n_prefix;
+    tables.sorted_rel = base + 3 * n_prefix;
+    tables.cum_q = tables.sorted_rel + n_suffix;
+    tables.cum_qr = tables.cum_q + n_suffix + 1;
+    return tables;
+}
+
+double sum_arithmetic_payoffs(
+    const ArithmeticTables& tables,
+    double S0, double strike_sum, bool is_call
+) {
+    double option_value = 0.0;
+
+    for (size_t i = 0; i < tables.n_prefix; ++i) {
+        option_value += arithmetic_prefix_payoff(tables, i, S0, strike_sum, is_call);
+    }
+
+    return option_value;
+}
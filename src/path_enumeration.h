@@ -0,0 +1,188 @@
+#ifndef PATH_ENUMERATION_H
+#define PATH_ENUMERATION_H
+
+#include "utils.h"
+#include "scratch_arena.h"
+#include "distribution_sketch.h"
+#include <vector>
+
+// Number of trailing steps tabulated once and swept for every prefix.
+// 2^12 entries of the table fit comfortably in L2 cache.
+const int SUFFIX_BLOCK_STEPS = 12;
+
+// Relative quantities of all 2^steps move sequences over a block of steps,
+// stored as contiguous arrays. All prices are relative to the block start.
+// The arrays live in the scratch frame passed to build_path_table and are
+// only valid while it is.
+struct PathTable {
+    int steps;
+    size_t count;
+    double* rel_log_sum;  // sum_{j=1}^{steps} log(S_j / S_start)
+    double* rel_sum;      // sum_{j=1}^{steps} S_j / S_start
+    double* rel_min;      // min_{0<=j<=steps} S_j / S_start
+    double* rel_max;      // max_{0<=j<=steps} S_j / S_start
+    double* rel_end;      // S_steps / S_start
+    double* prob;         // p^k (1-p)^(steps-k)
+
+    size_t size() const { return count; }
+};
+
+PathTable build_path_table(int steps, const AdjustedFactors& factors,
+                           ScratchFrame& frame);
+
+// Undiscounted expectations over the full 2^n tree of the geometric payoff
+// and of the geometric average itself. Realized fixings in `seasoning` enter
+// the average alongside S_0..S_n. Non-null sketches receive the payoff and
+// the average of every path, weighted by its probability.
+struct GeometricSums {
+    double payoff;
+    double G;
+};
+
+GeometricSums sum_geometric_payoffs(
+    double S0, double K, int n,
+    const AdjustedFactors& factors,
+    bool is_call,
+    const Seasoning& seasoning,
+    DistributionSketch* payoff_sketch = NULL,
+    DistributionSketch* average_sketch = NULL
+);
+
+// Undiscounted expectation of the arithmetic payoff max(0, A - K) (call) or
+// max(0, K - A) (put) over the full 2^n tree, by the same prefix/suffix
+// sweep as sum_geometric_payoffs, feeding the payoff and A of every path to
+// the sketches. For the price alone sum_arithmetic_payoffs is O(2^(n/2)).
+double sum_arithmetic_path_payoffs(
+    double S0, double K, int n,
+    const AdjustedFactors& factors,
+    bool is_call,
+    const Seasoning& seasoning,
+    DistributionSketch* payoff_sketch,
+    DistributionSketch* average_sketch
+);
+
+// Monte Carlo over the same tree: simulates n_simulations paths with R's
+// generator (the caller holds GetRNGstate) through the lane kernel and
+// accumulates the discounted payoff of the geometric or arithmetic average.
+// Sketches receive the undiscounted payoff and the average of every path.
+struct SimulatedSums {
+    double sum;
+    double sum_sq;
+};
+
+SimulatedSums simulate_asian_payoffs(
+    double S0, double K, int n,
+    const AdjustedFactors& factors,
+    bool is_call, bool arithmetic,
+    const Seasoning& seasoning,
+    int n_simulations, double discount,
+    DistributionSketch* payoff_sketch = NULL,
+    DistributionSketch* average_sketch = NULL
+);
+
+// Bid and ask side by side, writing the undiscounted expected payoffs to
+// expected[0..1]. Each side's tables are built separately from its own
+// factors; only the loop over them is shared. The geometric average walks
+// the move indices of the prefix/suffix split once and reads both sides'
+// path tables at each index, in O(2^n). The arithmetic average walks the
+// prefixes once and evaluates both sides' meet-in-the-middle tables at
+// each, in O(2^(n/2) n).
+void sum_two_sided_payoffs(
+    double S0, double K, int n,
+    const AdjustedFactors factors[2],
+    bool is_call, bool arithmetic,
+    const Seasoning& seasoning,
+    double expected[2]
+);
+
+// Monte Carlo counterpart: each uniform sets the move of both sides (up
+// iff U < p of the side), so the sides are coupled and the spread has the
+// standard error of the paired differences. Sums are of discounted payoffs.
+struct TwoSidedSums {
+    double sum[2];
+    double sum_sq[2];
+    double diff_sum;     // of payoff[1] - payoff[0]
+    double diff_sum_sq;
+};
+
+TwoSidedSums simulate_two_sided_payoffs(
+    double S0, double K, int n,
+    const AdjustedFactors factors[2],
+    bool is_call, bool arithmetic,
+    const Seasoning& seasoning,
+    int n_simulations, double discount
+);
+
+// Per-path quantities by path index, where bit j of the index is the move at
+// step j + 1 (1 = up) as in unpack_path_indices: the geometric and
+// arithmetic averages (with the fixings of `seasoning`), the spread
+// rho(omega) = exp((S_max - S_min)^2 / (4 S_min S_max)) of the
+// path-specific bound, and the probability p^k (1-p)^(n-k)
+const int PATH_FIELD_G = 0;
+const int PATH_FIELD_A = 1;
+const int PATH_FIELD_RHO = 2;
+const int PATH_FIELD_PROB = 3;
+
+struct PathFieldSpec {
+    int n;
+    double S0;
+    AdjustedFactors factors;
+    Seasoning seasoning;
+    int field;
+};
+
+// out[i] = field of path first + i for i < count, in O(n) per path
+void evaluate_path_field(const PathFieldSpec& spec, long long first,
+                         long long count, double* out);
+
+// Undiscounted E^Q[(rho(omega) - 1) * G(omega)] over the full 2^n tree.
+// For seasoned options the path range includes seasoning.min/max.
+double sum_path_specific_spread(
+    double S0, int n,
+    const AdjustedFactors& factors,
+    const Seasoning& seasoning
+);
+
+// Meet-in-the-middle tables for the arithmetic average: the path splits
+// after m = floor(n/2) steps, and the suffixes are sorted by their relative
+// sum R with cumulative sums of q and q R (cum_*[i] covers the first i).
+// Everything is relative to the spot, so one set of tables serves any S0.
+// Like PathTable, the arrays live in the scratch frame passed to
+// build_arithmetic_tables and are only valid while it is.
+struct ArithmeticTables {
+    int n;
+    size_t n_prefix;
+    size_t n_suffix;
+    const double* prefix_rel_sum;
+    const double* prefix_rel_end;
+    const double* prefix_prob;
+    const double* sorted_rel;  // n_suffix entries
+    const double* cum_q;       // n_suffix + 1 entries
+    const double* cum_qr;      // n_suffix + 1 entries
+};
+
+ArithmeticTables build_arithmetic_tables(int n, const AdjustedFactors& factors,
+                                         ScratchFrame& frame);
+
+// Owned copy of the tables for objects that outlive the call, such as
+// prepared models. The arrays are stored back to back in `data`, so copies
+// stay valid; view() points into it.
+struct StoredArithmeticTables {
+    int n;
+    size_t n_prefix;
+    size_t n_suffix;
+    std::vector<double> data;
+
+    ArithmeticTables view() const;
+};
+
+StoredArithmeticTables store_arithmetic_tables(const ArithmeticTables& tables);
+
+// Undiscounted E^Q[max(0, sum_i S_i - strike_sum)] (call) or
+// E^Q[max(0, strike_sum - sum_i S_i)] (put) over S_0..S_n
+double sum_arithmetic_payoffs(
+    const ArithmeticTables& tables,
+    double S0, double strike_sum, bool is_call
+);
+
+#endif
@@ -0,0 +1,323 @@
+#include "path_kernel.h"
+#include <cmath>
+#include <algorithm>
+
+// Runtime dispatch: GCC on x86-64 Linux emits AVX-512, AVX2 and baseline
+// clones of the kernel and picks one through an ifunc resolver at load
+// time. Elsewhere the portable version is compiled and left to the
+// compiler's vectorizer.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && \
+    defined(__linux__)
+#define PATH_KERNEL_TARGETS \
+    __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define PATH_KERNEL_TARGETS
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+
+// GCC vector extension: one value per lane, lowered to the widest registers
+// of the selected target (one zmm, two ymm or four xmm)
+typedef double lane_vector __attribute__((vector_size(PATH_LANES * sizeof(double))));
+
+PATH_KERNEL_TARGETS
+void evaluate_path_lanes(
+    const unsigned char* moves, int n, double S0,
+    const AdjustedFactors& factors,
+    PathLanes& out
+) {
+    const double u = factors.u_tilde;
+    const double d = factors.d_tilde;
+    const double log_u = std::log(u);
+    const double log_d = std::log(d);
+    const double log_S0 = std::log(S0);
+
+    const lane_vector zero = {};
+    lane_vector S = zero + S0;
+    lane_vector log_S = zero + log_S0;
+    lane_vector sum = S;
+    lane_vector log_sum = log_S;
+    lane_vector S_min = S;
+    lane_vector S_max = S;
+    lane_vector ups = zero;
+
+    for (int j = 0; j < n; ++j) {
+        const unsigned char* step = moves + (size_t)j * PATH_LANES;
+
+        lane_vector up;
+        for (int l = 0; l < PATH_LANES; ++l) {
+            up[l] = step[l];
+        }
+
+        S *= d + up * (u - d);
+        log_S += log_d + up * (log_u - log_d);
+
+        sum += S;
+        log_sum += log_S;
+        S_min = S < S_min ? S : S_min;
+        S_max = S > S_max ? S : S_max;
+        ups += up;
+    }
+
+    for (int l = 0; l < PATH_LANES; ++l) {
+        out.G[l] = std::exp(log_sum[l] / (n + 1));
+        out.A[l] = sum[l] / (n + 1);
+        out.S_min[l] = S_min[l];
+        out.S_max[l] = S_max[l];
+        out.prob[l] = std::pow(factors.p_adj, ups[l]) *
+                      std::pow(1.0 - factors.p_adj, n - ups[l]);
+    }
+}
+
+PATH_KERNEL_TARGETS
+void evaluate_european_lanes(
+    const EuropeanLanes& in, int n_max, double* value
+) {
+    lane_vector S, ratio, weight, odds, n, K, sign;
+    for (int l = 0; l < PATH_LANES; ++l) {
+        S[l] = in.S_start[l];
+        ratio[l] = in.ratio[l];
+        weight[l] = in.weight[l];
+        odds[l] = in.odds[l];
+        n[l] = in.n[l];
+        K[l] = in.K[l];
+        sign[l] = in.sign[l];
+    }
+
+    const lane_vector zero = {};
+    lane_vector total = zero;
+
+    for (int k = 0; k <= n_max; ++k) {
+        double kd = k;
+
+        lane_vector payoff = sign * (S - K);
+        payoff = payoff > zero ? payoff : zero;
+
+        // Padded lanes may overflow S past their n, so mask rather than
+        // rely on the zero weight
+        lane_vector term = weight * payoff;
+        total += (n >= kd) ? term : zero;
+
+        weight *= (n - kd) * (1.0 / (kd + 1.0)) * odds;
+        S *= ratio;
+    }
+
+    for (int l = 0; l < PATH_LANES; ++l) {
+        value[l] = total[l];
+    }
+}
+
+PATH_KERNEL_TARGETS
+void evaluate_tarf_lanes(
+    const unsigned char* moves, int n, double S0,
+    const AdjustedFactors& factors, const TarfTerms& terms,
+    TarfLanes& out
+) {
+    const double u = factors.u_tilde;
+    const double d = factors.d_tilde;
+
+    const lane_vector zero = {};
+    const lane_vector one = zero + 1.0;
+    lane_vector S = zero + S0;
+    lane_vector accumulated = zero + terms.accrued;
+    lane_vector alive = one;
+    lane_vector value = zero;
+    lane_vector knockout = zero;
+    double discount = 1.0;
+
+    for (int j = 0; j < n; ++j) {
+        const unsigned char* step = moves + (size_t)j * PATH_LANES;
+
+        lane_vector up;
+        for (int l = 0; l < PATH_LANES; ++l) {
+            up[l] = step[l];
+        }
+
+        S *= d + up * (u - d);
+        discount *= terms.discount;
+
+        lane_vector diff = terms.sign * (S - terms.K);
+        lane_vector gain = diff > zero ? diff : zero;
+        lane_vector cash = diff > zero ? diff : terms.leverage * diff;
+        lane_vector next = accumulated + gain;
+        lane_vector out_now = next >= terms.target ? alive : zero;
+
+        lane_vector knockout_cash = cash;
+        if (terms.knockout == TARF_KNOCKOUT_CAPPED) {
+            knockout_cash = terms.target - accumulated;
+        } else if (terms.knockout == TARF_KNOCKOUT_NONE) {
+            knockout_cash = zero;
+        }
+
+        cash = out_now > zero ? knockout_cash : cash;
+        value += alive * discount * cash;
+        knockout += out_now * (j + 1.0);
+        alive -= out_now;
+        accumulated = next;
+    }
+
+    for (int l = 0; l < PATH_LANES; ++l) {
+        out.value[l] = value[l];
+        out.knockout[l] = knockout[l];
+    }
+}
+
+#else
+
+// Portable version: fixed-width lane loops for the compiler's vectorizer
+void evaluate_path_lanes(
+    const unsigned char* moves, int n, double S0,
+    const AdjustedFactors& factors,
+    PathLanes& out
+) {
+    const double u = factors.u_tilde;
+    const double d = factors.d_tilde;
+    const double log_u = std::log(u);
+    const double log_d = std::log(d);
+    const double log_S0 = std::log(S0);
+
+    double S[PATH_LANES];
+    double log_S[PATH_LANES];
+    double sum[PATH_LANES];
+    double log_sum[PATH_LANES];
+    double S_min[PATH_LANES];
+    double S_max[PATH_LANES];
+    double ups[PATH_LANES];
+
+    for (int l = 0; l < PATH_LANES; ++l) {
+        S[l] = S0;
+        log_S[l] = log_S0;
+        sum[l] = S0;
+        log_sum[l] = log_S0;
+        S_min[l] = S0;
+        S_max[l] = S0;
+        ups[l] = 0.0;
+    }
+
+    for (int j = 0; j < n; ++j) {
+        const unsigned char* step = moves + (size_t)j * PATH_LANES;
+
+        for (int l = 0; l < PATH_LANES; ++l) {
+            double up = step[l];
+
+            S[l] *= d + up * (u - d);
+            log_S[l] += log_d + up * (log_u - log_d);
+
+            sum[l] += S[l];
+            log_sum[l] += log_S[l];
+            S_min[l] = std::min(S_min[l], S[l]);
+            S_max[l] = std::max(S_max[l], S[l]);
+            ups[l] += up;
+        }
+    }
+
+    for (int l = 0; l < PATH_LANES; ++l) {
+        out.G[l] = std::exp(log_sum[l] / (n + 1));
+        out.A[l] = sum[l] / (n + 1);
+        out.S_min[l] = S_min[l];
+        out.S_max[l] = S_max[l];
+        out.prob[l] = std::pow(factors.p_adj, ups[l]) *
+                      std::pow(1.0 - factors.p_adj, n - ups[l]);
+    }
+}
+
+void evaluate_european_lanes(
+    const EuropeanLanes& in, int n_max, double* value
+) {
+    double S[PATH_LANES];
+    double weight[PATH_LANES];
+    double total[PATH_LANES];
+
+    for (int l = 0; l < PATH_LANES; ++l) {
+        S[l] = in.S_start[l];
+        weight[l] = in.weight[l];
+        total[l] = 0.0;
+    }
+
+    for (int k = 0; k <= n_max; ++k) {
+        for (int l = 0; l < PATH_LANES; ++l) {
+            double payoff = std::max(0.0, in.sign[l] * (S[l] - in.K[l]));
+            total[l] += (in.n[l] >= k) ? weight[l] * payoff : 0.0;
+
+            weight[l] *= (in.n[l] - k) * (1.0 / (k + 1)) * in.odds[l];
+            S[l] *= in.ratio[l];
+        }
+    }
+
+    for (int l = 0; l < PATH_LANES; ++l) {
+        value[l] = total[l];
+    }
+}
+
+void evaluate_tarf_lanes(
+    const unsigned char* moves, int n, double S0,
+    const AdjustedFactors& factors, const TarfTerms& terms,
+    TarfLanes& out
+) {
+    const double u = factors.u_tilde;
+    const double d = factors.d_tilde;
+
+    double S[PATH_LANES];
+    double accumulated[PATH_LANES];
+    double alive[PATH_LANES];
+    double value[PATH_LANES];
+    double knockout[PATH_LANES];
+    double discount = 1.0;
+
+    for (int l = 0; l < PATH_LANES; ++l) {
+        S[l] = S0;
+        accumulated[l] = terms.accrued;
+        alive[l] = 1.0;
+        value[l] = 0.0;
+        knockout[l] = 0.0;
+    }
+
+    for (int j = 0; j < n; ++j) {
+        const unsigned char* step = moves + (size_t)j * PATH_LANES;
+        discount *= terms.discount;
+
+        for (int l = 0; l < PATH_LANES; ++l) {
+            double up = step[l];
+            S[l] *= d + up * (u - d);
+
+            double diff = terms.sign * (S[l] - terms.K);
+            double gain = std::max(0.0, diff);
+            double cash = diff > 0.0 ? diff : terms.leverage * diff;
+            double next = accumulated[l] + gain;
+            double out_now = next >= terms.target ? alive[l] : 0.0;
+
+            if (out_now > 0.0) {
+                if (terms.knockout == TARF_KNOCKOUT_CAPPED) {
+                    cash = terms.target - accumulated[l];
+                } else if (terms.knockout == TARF_KNOCKOUT_NONE) {
+                    cash = 0.0;
+                }
+            }
+
+            value[l] += alive[l] * discount * cash;
+            knockout[l] += out_now * (j + 1.0);
+            alive[l] -= out_now;
+            accumulated[l] = next;
+        }
+    }
+
+    for (int l = 0; l < PATH_LANES; ++l) {
+        out.value[l] = value[l];
+        out.knockout[l] = knockout[l];
+    }
+}
+
+#endif
+
+void unpack_path_indices(
+    const long long* indices, int count, int n,
+    unsigned char* moves
+) {
+    for (int j = 0; j < n; ++j) {
+        unsigned char* step = moves + (size_t)j * PATH_LANES;
+
+        for (int l = 0; l < PATH_LANES; ++l) {
+            step[l] = (l < count) ? (unsigned char)((indices[l] >> j) & 1) : 0;
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef PATH_KERNEL_H
+#define PATH_KERNEL_H
+
+#include "utils.h"
+
+// Number of paths evaluated together, one path per SIMD lane
+// (one AVX-512 register or two AVX2 registers of doubles)
+const int PATH_LANES = 8;
+
+// Per-lane path statistics; entry l of every array belongs to path l
+struct PathLanes {
+    double G[PATH_LANES];      // geometric average of S_0..S_n
+    double A[PATH_LANES];      // arithmetic average of S_0..S_n
+    double S_min[PATH_LANES];  // minimum price along the path
+    double S_max[PATH_LANES];  // maximum price along the path
+    double prob[PATH_LANES];   // p^k (1-p)^(n-k)
+};
+
+// Evaluates PATH_LANES paths in one pass over the steps.
+// moves[j * PATH_LANES + l] is the move of path l at step j (1 = up, 0 = down).
+// The widest instruction set supported by the CPU is selected at load time
+// where the toolchain allows it.
+void evaluate_path_lanes(
+    const unsigned char* moves, int n, double S0,
+    const AdjustedFactors& factors,
+    PathLanes& out
+);
+
+// Structure-of-arrays inputs of PATH_LANES European options, one option per
+// lane. Unused lanes have n = -1.
+struct EuropeanLanes {
+    double S_start[PATH_LANES];  // S0 d_tilde^n, the all-down terminal price
+    double ratio[PATH_LANES];    // u_tilde / d_tilde
+    double weight[PATH_LANES];   // (1 - p)^n / r^n, the discounted k = 0 weight
+    double odds[PATH_LANES];     // p / (1 - p)
+    double n[PATH_LANES];
+    double K[PATH_LANES];
+    double sign[PATH_LANES];     // +1 call, -1 put
+};
+
+// Discounted European prices of the lanes. Terminal prices and binomial
+// weights follow multiplicative recurrences in k, so the loop over
+// k = 0..n_max has no transcendental calls; lanes with a smaller n are
+// padded and contribute nothing past their own n. The recurrence starts
+// from the k = 0 terms, so they must be normal doubles.
+void evaluate_european_lanes(
+    const EuropeanLanes& in, int n_max, double* value
+);
+
+// Target accrual forward (TARF) terms per unit notional. At each step the
+// fixing S pays c = sign (S - K) when positive and leverage times it when
+// negative; the positive parts accumulate from `accrued`, and the fixing
+// that brings them to `target` knocks the contract out, paying c in full,
+// only the remainder target - accumulated (capped), or nothing.
+const int TARF_KNOCKOUT_FULL = 0;
+const int TARF_KNOCKOUT_CAPPED = 1;
+const int TARF_KNOCKOUT_NONE = 2;
+
+struct TarfTerms {
+    double K;
+    double target;
+    double leverage;
+    double sign;      // +1 to buy at K (call), -1 to sell at K (put)
+    int knockout;
+    double accrued;   // gain accumulated before S0
+    double discount;  // 1 / r, per step
+};
+
+struct TarfLanes {
+    double value[PATH_LANES];      // discounted cash flows to the holder
+    double knockout[PATH_LANES];   // step of the knock-out, or 0 if none
+};
+
+// Runs PATH_LANES TARF paths through their n fixings in one pass, with the
+// move layout of evaluate_path_lanes
+void evaluate_tarf_lanes(
+    const unsigned char* moves, int n, double S0,
+    const AdjustedFactors& factors, const TarfTerms& terms,
+    TarfLanes& out
+);
+
+// Writes the bits of up to PATH_LANES path indices (bit j = move at step j)
+// into the lane-interleaved move layout; unused lanes are set to 0
+void unpack_path_indices(
+    const long long* indices, int count, int n,
+    unsigned char* moves
+);
+
+#endif
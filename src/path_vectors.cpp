@@ -0,0 +1,208 @@
+#include <Rcpp.h>
+#include <R_ext/Altrep.h>
+#include "utils.h"
+#include "path_enumeration.h"
+#include <algorithm>
+
+// Lazy per-path vectors over the 2^n paths of the impacted tree. Each is an
+// ALTREP real vector whose data1 is an external pointer to its
+// PathFieldSpec; elements and regions are computed from the path index on
+// demand, so indexing, head() or a sum never hold more than R's iteration
+// buffer. Only a request for the full data pointer (arithmetic on the whole
+// vector, for example) materializes it, into data2.
+
+static R_altrep_class_t path_field_class;
+
+static const char* const FIELD_NAMES[] = {"G", "A", "rho", "prob"};
+
+static const PathFieldSpec& field_spec(SEXP x) {
+    return *static_cast<PathFieldSpec*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+}
+
+static SEXP make_path_field(const PathFieldSpec& spec) {
+    Rcpp::XPtr<PathFieldSpec> ptr(new PathFieldSpec(spec), true);
+    return R_new_altrep(path_field_class, ptr, R_NilValue);
+}
+
+static R_xlen_t path_field_length(SEXP x) {
+    return (R_xlen_t)1 << field_spec(x).n;
+}
+
+static Rboolean path_field_inspect(SEXP x, int /* pre */, int /* deep */,
+                                   int /* pvec */,
+                                   void (* /* inspect_subtree */)(SEXP, int, int, int)) {
+    const PathFieldSpec& spec = field_spec(x);
+    Rprintf(" asian_path_field %s (n = %d, %s)\n", FIELD_NAMES[spec.field], spec.n,
+            R_altrep_data2(x) == R_NilValue ? "lazy" : "materialized");
+    return TRUE;
+}
+
+static double path_field_elt(SEXP x, R_xlen_t i) {
+    SEXP data = R_altrep_data2(x);
+    if (data != R_NilValue) {
+        return REAL(data)[i];
+    }
+
+    double value;
+    evaluate_path_field(field_spec(x), i, 1, &value);
+    return value;
+}
+
+static R_xlen_t path_field_get_region(SEXP x, R_xlen_t start, R_xlen_t size,
+                                      double* buf) {
+    R_xlen_t count = std::min(size, path_field_length(x) - start);
+
+    SEXP data = R_altrep_data2(x);
+    if (data != R_NilValue) {
+        std::copy(REAL(data) + start, REAL(data) + start + count, buf);
+    } else {
+        evaluate_path_field(field_spec(x), start, count, buf);
+    }
+    return count;
+}
+
+static void* path_field_dataptr(SEXP x, Rboolean /* writeable */) {
+    SEXP data = R_altrep_data2(x);
+    if (data == R_NilValue) {
+        R_xlen_t length = path_field_length(x);
+        data = PROTECT(Rf_allocVector(REALSXP, length));
+        evaluate_path_field(field_spec(x), 0, length, REAL(data));
+        R_set_altrep_data2(x, data);
+        UNPROTECT(1);
+    }
+    return REAL(data);
+}
+
+static const void* path_field_dataptr_or_null(SEXP x) {
+    SEXP data = R_altrep_data2(x);
+    return data == R_NilValue ? NULL : REAL(data);
+}
+
+// A lazy vector duplicates and serializes as its recipe; once materialized
+// (and possibly written to) it falls back to R's defaults
+static SEXP path_field_duplicate(SEXP x, Rboolean /* deep */) {
+    if (R_altrep_data2(x) != R_NilValue) {
+        return NULL;
+    }
+    return make_path_field(field_spec(x));
+}
+
+static SEXP path_field_serialized_state(SEXP x) {
+    if (R_altrep_data2(x) != R_NilValue) {
+        return NULL;
+    }
+
+    const PathFieldSpec& spec = field_spec(x);
+    SEXP state = PROTECT(Rf_allocVector(REALSXP, 11));
+    double* s = REAL(state);
+    s[0] = spec.n;
+    s[1] = spec.S0;
+    s[2] = spec.factors.u_tilde;
+    s[3] = spec.factors.d_tilde;
+    s[4] = spec.factors.p_adj;
+    s[5] = spec.seasoning.count;
+    s[6] = spec.seasoning.sum;
+    s[7] = spec.seasoning.log_sum;
+    s[8] = spec.seasoning.min;
+    s[9] = spec.seasoning.max;
+    s[10] = spec.field;
+    UNPROTECT(1);
+    return state;
+}
+
+static SEXP path_field_unserialize(SEXP /* cls */, SEXP state) {
+    const double* s = REAL(state);
+
+    PathFieldSpec spec;
+    spec.n = (int)s[0];
+    spec.S0 = s[1];
+    spec.factors.u_tilde = s[2];
+    spec.factors.d_tilde = s[3];
+    spec.factors.p_adj = s[4];
+    spec.seasoning = make_seasoning((int)s[5], s[6], s[7], s[8], s[9]);
+    spec.field = (int)s[10];
+
+    return make_path_field(spec);
+}
+
+// [[Rcpp::init]]
+void register_path_vectors(DllInfo* dll) {
+    path_field_class = R_make_altreal_class("asian_path_field", "AsianOptPI", dll);
+
+    R_set_altrep_Length_method(path_field_class, path_field_length);
+    R_set_altrep_Inspect_method(path_field_class, path_field_inspect);
+    R_set_altrep_Duplicate_method(path_field_class, path_field_duplicate);
+    R_set_altrep_Serialized_state_method(path_field_class, path_field_serialized_state);
+    R_set_altrep_Unserialize_method(path_field_class, path_field_unserialize);
+    R_set_altvec_Dataptr_method(path_field_class, path_field_dataptr);
+    R_set_altvec_Dataptr_or_null_method(path_field_class, path_field_dataptr_or_null);
+    R_set_altreal_Elt_method(path_field_class, path_field_elt);
+    R_set_altreal_Get_region_method(path_field_class, path_field_get_region);
+}
+
+//' Lazy Per-Path Vectors of the Impacted Binomial Tree
+//'
+//' @param S0 Initial stock price (positive)
+//' @param r Gross risk-free rate per period
+//' @param u Base up factor in CRR model
+//' @param d Base down factor in CRR model
+//' @param lambda Price impact coefficient (non-negative)
+//' @param v_u Hedging volume on up move (non-negative)
+//' @param v_d Hedging volume on down move (non-negative)
+//' @param n Number of time steps (1 to 52)
+//' @param n_fixed Number of fixings already realized before \code{S0}
+//'   (default: 0)
+//' @param fixed_sum Sum of the realized fixings (default: 0)
+//' @param fixed_log_sum Sum of the logs of the realized fixings (default: 0)
+//' @param fixed_min Smallest realized fixing (default: NA)
+//' @param fixed_max Largest realized fixing (default: NA)
+//'
+//' @return List of four ALTREP numeric vectors of length \eqn{2^n}:
+//'   \code{G}, \code{A}, \code{rho} and \code{prob}
+//'
+//' @details
+//' Element \eqn{i + 1} belongs to the path whose move at step \eqn{j + 1}
+//' is bit \eqn{j} of \eqn{i} (1 = up). Elements are computed in
+//' \eqn{O(n)} when R reads them and nothing is stored until R asks for the
+//' whole data pointer.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List path_vectors_cpp(
+    double S0, double r, double u, double d,
+    double lambda, double v_u, double v_d, int n,
+    int n_fixed = 0, double fixed_sum = 0.0, double fixed_log_sum = 0.0,
+    double fixed_min = NA_REAL, double fixed_max = NA_REAL
+) {
+    if (n <= 0 || n > 52) {
+        Rcpp::stop("n must be an integer between 1 and 52");
+    }
+    if (!(S0 > 0)) {
+        Rcpp::stop("S0 must be positive");
+    }
+
+    PathFieldSpec spec;
+    spec.n = n;
+    spec.S0 = S0;
+    spec.factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+    spec.seasoning = make_seasoning(n_fixed, fixed_sum, fixed_log_sum,
+                                    fixed_min, fixed_max);
+
+    // Held as plain SEXPs: wrapping them in NumericVector would ask for the
+    // data pointer and materialize them
+    spec.field = PATH_FIELD_G;
+    Rcpp::Shield<SEXP> G(make_path_field(spec));
+    spec.field = PATH_FIELD_A;
+    Rcpp::Shield<SEXP> A(make_path_field(spec));
+    spec.field = PATH_FIELD_RHO;
+    Rcpp::Shield<SEXP> rho(make_path_field(spec));
+    spec.field = PATH_FIELD_PROB;
+    Rcpp::Shield<SEXP> prob(make_path_field(spec));
+
+    return Rcpp::List::create(
+        Rcpp::Named("G") = (SEXP)G,
+        Rcpp::Named("A") = (SEXP)A,
+        Rcpp::Named("rho") = (SEXP)rho,
+        Rcpp::Named("prob") = (SEXP)prob
+    );
+}
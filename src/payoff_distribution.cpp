@@ -0,0 +1,154 @@
+#include <Rcpp.h>
+#include "utils.h"
+#include "path_enumeration.h"
+#include "geometric_distribution.h"
+#include "distribution_sketch.h"
+#include <cmath>
+#include <algorithm>
+
+//' Price an Asian Option Together with the Distribution of Its Payoff
+//'
+//' Runs an exact enumeration, the weighted up-count DP or Monte Carlo on the
+//' binomial tree with price impact, and summarizes the payoff and the
+//' average of every path or state in the same pass.
+//'
+//' @param S0 Initial stock price (positive)
+//' @param K Strike price (positive)
+//' @param r Gross risk-free rate per period
+//' @param u Base up factor in CRR model
+//' @param d Base down factor in CRR model
+//' @param lambda Price impact coefficient (non-negative)
+//' @param v_u Hedging volume on up move (non-negative)
+//' @param v_d Hedging volume on down move (non-negative)
+//' @param n Number of time steps (positive integer)
+//' @param probs Probabilities at which to report quantiles
+//' @param option_type "call" or "put"
+//' @param average "geometric" or "arithmetic"
+//' @param method "exact" (all 2^n paths), "dp" (geometric only) or "mc"
+//' @param n_simulations Number of Monte Carlo paths
+//' @param seed Random seed for reproducibility (default: -1 for no seed)
+//' @param n_fixed Number of fixings already realized before \code{S0}
+//'   (default: 0)
+//' @param fixed_sum Sum of the realized fixings (default: 0)
+//' @param fixed_log_sum Sum of the logs of the realized fixings (default: 0)
+//' @param accuracy Relative accuracy of the bins and quantiles (default:
+//'   0.01)
+//'
+//' @return List with the discounted \code{price}, its \code{std_error} (0
+//'   unless Monte Carlo) and summaries \code{payoff} (undiscounted) and
+//'   \code{average}, each a list of \code{mean}, \code{min}, \code{max},
+//'   \code{zero_mass}, histogram \code{breaks} and \code{mass}, \code{probs}
+//'   and \code{quantiles}
+//'
+//' @details
+//' Values are binned on the fly into logarithmic bins
+//' \eqn{(\gamma^{i-1}, \gamma^i]} with
+//' \eqn{\gamma = (1 + accuracy) / (1 - accuracy)}, weighted by the path
+//' probability (exact), the state probability (DP) or one per path (Monte
+//' Carlo). Zero payoffs are counted apart. Every quantile is within a
+//' factor \eqn{1 \pm accuracy} of the exact one for the summarized
+//' distribution, and the bins need no range fixed in advance.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List payoff_distribution_cpp(
+    double S0, double K, double r, double u, double d,
+    double lambda, double v_u, double v_d, int n,
+    Rcpp::NumericVector probs,
+    std::string option_type = "call",
+    std::string average = "geometric",
+    std::string method = "exact",
+    int n_simulations = 100000,
+    int seed = -1,
+    int n_fixed = 0, double fixed_sum = 0.0, double fixed_log_sum = 0.0,
+    double accuracy = 0.01
+) {
+    if (n <= 0) {
+        Rcpp::stop("n must be a positive integer");
+    }
+    if (option_type != "call" && option_type != "put") {
+        Rcpp::stop("option_type must be either 'call' or 'put'");
+    }
+    if (average != "geometric" && average != "arithmetic") {
+        Rcpp::stop("average must be either 'geometric' or 'arithmetic'");
+    }
+    if (method != "exact" && method != "dp" && method != "mc") {
+        Rcpp::stop("method must be one of 'exact', 'dp' or 'mc'");
+    }
+    if (method == "dp" && average != "geometric") {
+        Rcpp::stop("the dp method applies to the geometric average only");
+    }
+    if (method == "mc" && n_simulations <= 0) {
+        Rcpp::stop("n_simulations must be positive");
+    }
+    int count = probs.size();
+    for (int i = 0; i < count; ++i) {
+        if (!(probs[i] >= 0.0 && probs[i] <= 1.0)) {
+            Rcpp::stop("probs must be in [0, 1]");
+        }
+    }
+
+    bool is_call = (option_type == "call");
+    bool arithmetic = (average == "arithmetic");
+
+    Seasoning seasoning = make_seasoning(n_fixed, fixed_sum, fixed_log_sum);
+    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+    double discount = std::pow(r, -n);
+
+    DistributionSketch payoffs(accuracy);
+    DistributionSketch averages(accuracy);
+
+    double price;
+    double std_error = 0.0;
+
+    if (method == "exact") {
+        if (arithmetic) {
+            price = discount * sum_arithmetic_path_payoffs(S0, K, n, factors, is_call,
+                                                           seasoning, &payoffs, &averages);
+        } else {
+            price = discount * sum_geometric_payoffs(S0, K, n, factors, is_call,
+                                                     seasoning, &payoffs, &averages).payoff;
+        }
+    } else if (method == "dp") {
+        GeometricDistribution dist = build_geometric_distribution(n, factors, n_fixed);
+        double level = std::exp(fixed_log_sum / (n_fixed + n + 1) +
+                                dist.exponent * std::log(S0));
+
+        double expected = 0.0;
+        for (size_t i = 0; i < dist.size(); ++i) {
+            double G = level * dist.h[i];
+            double payoff = is_call ? std::max(0.0, G - K) : std::max(0.0, K - G);
+            expected += dist.prob[i] * payoff;
+            payoffs.add(payoff, dist.prob[i]);
+            averages.add(G, dist.prob[i]);
+        }
+        price = discount * expected;
+    } else {
+        if (seed >= 0) {
+            Rcpp::Environment base_env("package:base");
+            Rcpp::Function set_seed = base_env["set.seed"];
+            set_seed(seed);
+        }
+
+        GetRNGstate();
+
+        SimulatedSums sums = simulate_asian_payoffs(S0, K, n, factors, is_call,
+                                                    arithmetic, seasoning,
+                                                    n_simulations, discount,
+                                                    &payoffs, &averages);
+
+        PutRNGstate();
+
+        price = sums.sum / n_simulations;
+        double variance = sums.sum_sq / n_simulations - price * price;
+        std_error = std::sqrt(std::max(0.0, variance) / n_simulations);
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("price") = price,
+        Rcpp::Named("std_error") = std_error,
+        Rcpp::Named("discount") = discount,
+        Rcpp::Named("payoff") = payoffs.summary(probs),
+        Rcpp::Named("average") = averages.summary(probs)
+    );
+}
@@ -0,0 +1,336 @@
+#include "polynomial_product.h"
+#include "scratch_arena.h"
+#include <complex>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+typedef std::complex<double> Complex;
+
+// Shorter factors than this are multiplied directly
+static const size_t DIRECT_MAX_LENGTH = 48;
+
+// Weight ranges this short are built by the in-place recursion
+static const int LEAF_WEIGHTS = 64;
+
+static const double PI = 3.14159265358979323846;
+
+// Plain complex product: operator* guards against infinities through a
+// library call that dominates the transform
+static inline Complex multiply(const Complex& a, const Complex& b) {
+    return Complex(a.real() * b.real() - a.imag() * b.imag(),
+                   a.real() * b.imag() + a.imag() * b.real());
+}
+
+// Depth-first radix-2 transforms, so that every subproblem from the cache
+// size down stays in cache, with two stages fused per pass over memory. The
+// forward transform takes natural order to bit-reversed order and the
+// inverse (unscaled) takes it back, which is all a convolution needs. A
+// stage of length len = 2 half reads its roots exp(-2 pi i k / len), k < half,
+// contiguously from twiddles[half + k].
+static void fft_forward(Complex* x, size_t len, const Complex* twiddles) {
+    if (len < 2) {
+        return;
+    }
+    size_t half = len >> 1;
+    const Complex* w = twiddles + half;
+
+    if (len == 2) {
+        Complex a = x[0];
+        x[0] = a + x[1];
+        x[1] = a - x[1];
+        return;
+    }
+
+    // Stage len on the quarters (0, 2) and (1, 3), then stage half on (0, 1)
+    // and (2, 3)
+    size_t quarter = half >> 1;
+    const Complex* v = twiddles + quarter;
+    Complex* x1 = x + quarter;
+    Complex* x2 = x + half;
+    Complex* x3 = x2 + quarter;
+    for (size_t k = 0; k < quarter; ++k) {
+        Complex a0 = x[k], a1 = x1[k], a2 = x2[k], a3 = x3[k];
+        Complex b0 = a0 + a2;
+        Complex b1 = a1 + a3;
+        Complex b2 = multiply(a0 - a2, w[k]);
+        Complex b3 = multiply(a1 - a3, w[k + quarter]);
+        x[k] = b0 + b1;
+        x1[k] = multiply(b0 - b1, v[k]);
+        x2[k] = b2 + b3;
+        x3[k] = multiply(b2 - b3, v[k]);
+    }
+    fft_forward(x, quarter, twiddles);
+    fft_forward(x1, quarter, twiddles);
+    fft_forward(x2, quarter, twiddles);
+    fft_forward(x3, quarter, twiddles);
+}
+
+static void fft_inverse(Complex* x, size_t len, const Complex* twiddles) {
+    if (len < 2) {
+        return;
+    }
+    size_t half = len >> 1;
+    const Complex* w = twiddles + half;
+
+    if (len == 2) {
+        Complex a = x[0];
+        x[0] = a + x[1];
+        x[1] = a - x[1];
+        return;
+    }
+
+    size_t quarter = half >> 1;
+    const Complex* v = twiddles + quarter;
+    Complex* x1 = x + quarter;
+    Complex* x2 = x + half;
+    Complex* x3 = x2 + quarter;
+    fft_inverse(x, quarter, twiddles);
+    fft_inverse(x1, quarter, twiddles);
+    fft_inverse(x2, quarter, twiddles);
+    fft_inverse(x3, quarter, twiddles);
+    for (size_t k = 0; k < quarter; ++k) {
+        Complex t1 = multiply(std::conj(v[k]), x1[k]);
+        Complex t3 = multiply(std::conj(v[k]), x3[k]);
+        Complex b0 = x[k] + t1;
+        Complex b1 = x[k] - t1;
+        Complex b2 = x2[k] + t3;
+        Complex b3 = x2[k] - t3;
+        Complex t2 = multiply(std::conj(w[k]), b2);
+        Complex u3 = multiply(std::conj(w[k + quarter]), b3);
+        x[k] = b0 + t2;
+        x2[k] = b0 - t2;
+        x1[k] = b1 + u3;
+        x3[k] = b1 - u3;
+    }
+}
+
+// Twiddles for every transform length up to L. Each root of the longest
+// transform comes from its own angle, so rounding does not build up along
+// k, and the roots of a length len are the even-indexed ones of 2 len.
+static Complex* build_twiddles(size_t L, ScratchFrame& frame) {
+    Complex* twiddles = frame.allocate<Complex>(std::max<size_t>(L, 2));
+    size_t top = L / 2;
+    for (size_t k = 0; k < top; ++k) {
+        double angle = -2.0 * PI * (double)k / (double)L;
+        twiddles[top + k] = Complex(std::cos(angle), std::sin(angle));
+    }
+    for (size_t half = top / 2; half >= 1; half >>= 1) {
+        for (size_t k = 0; k < half; ++k) {
+            twiddles[half + k] = twiddles[2 * half + 2 * k];
+        }
+    }
+    return twiddles;
+}
+
+// Replaces the transform Z of a + i b, in bit-reversed order, by the
+// transform of a * b. With Z* the conjugate of Z at -k, A = (Z + Z*)/2 and
+// B = (Z - Z*)/2i, so A B = (Z^2 - Z*^2)/4i. Positions 0 and 1 hold the
+// self-conjugate frequencies 0 and L/2; otherwise the frequencies of the
+// block [b, 2b) of positions are the odd multiples of L/2b, and -k sits at
+// the mirrored position 3b - 1 - p.
+static void multiply_packed_spectrum(Complex* z, size_t L) {
+    const Complex quarter_i(0.0, -0.25);
+
+    for (size_t p = 0; p < std::min<size_t>(L, 2); ++p) {
+        Complex zp = z[p];
+        z[p] = multiply(multiply(zp, zp) - multiply(std::conj(zp), std::conj(zp)),
+                        quarter_i);
+    }
+
+    for (size_t b = 2; b < L; b <<= 1) {
+        for (size_t p = b; p < b + b / 2; ++p) {
+            size_t m = 3 * b - 1 - p;
+            Complex zp = z[p];
+            Complex zm = z[m];
+            z[p] = multiply(multiply(zp, zp) - multiply(std::conj(zm), std::conj(zm)),
+                            quarter_i);
+            z[m] = multiply(multiply(zm, zm) - multiply(std::conj(zp), std::conj(zp)),
+                            quarter_i);
+        }
+    }
+}
+
+static size_t fft_length(size_t count) {
+    size_t L = 1;
+    while (L < count) {
+        L <<= 1;
+    }
+    return L;
+}
+
+static bool use_direct(const std::vector<double>& a, const std::vector<double>& b) {
+    return std::min(a.size(), b.size()) <= DIRECT_MAX_LENGTH;
+}
+
+static void convolve_direct(const std::vector<double>& a,
+                            const std::vector<double>& b,
+                            std::vector<double>& c) {
+    c.assign(a.size() + b.size() - 1, 0.0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        for (size_t j = 0; j < b.size(); ++j) {
+            c[i + j] += a[i] * b[j];
+        }
+    }
+}
+
+// Transform of a + i b into z, zero-padded to L
+static void load_packed(const std::vector<double>& a, const std::vector<double>& b,
+                        Complex* z, size_t L, const Complex* twiddles) {
+    for (size_t j = 0; j < L; ++j) {
+        z[j] = Complex(j < a.size() ? a[j] : 0.0, j < b.size() ? b[j] : 0.0);
+    }
+    fft_forward(z, L, twiddles);
+    multiply_packed_spectrum(z, L);
+}
+
+static void store_product(const Complex* z, size_t count, double scale,
+                          bool imaginary, std::vector<double>& c) {
+    c.resize(count);
+    for (size_t j = 0; j < count; ++j) {
+        double value = (imaginary ? z[j].imag() : z[j].real()) * scale;
+        c[j] = value < 0.0 ? 0.0 : value;
+    }
+}
+
+// convolve_pair with twiddles for at least the transform length needed
+static void convolve_pair_with(
+    const std::vector<double>& a1, const std::vector<double>& b1,
+    const std::vector<double>& a2, const std::vector<double>& b2,
+    std::vector<double>& c1, std::vector<double>& c2,
+    const Complex* twiddles
+) {
+    if (use_direct(a1, b1) || use_direct(a2, b2)) {
+        convolve_direct(a1, b1, c1);
+        convolve_direct(a2, b2, c2);
+        return;
+    }
+
+    size_t count1 = a1.size() + b1.size() - 1;
+    size_t count2 = a2.size() + b2.size() - 1;
+    size_t L = fft_length(std::max(count1, count2));
+
+    ScratchFrame frame;
+    Complex* z1 = frame.allocate<Complex>(L);
+    Complex* z2 = frame.allocate<Complex>(L);
+
+    load_packed(a1, b1, z1, L, twiddles);
+    load_packed(a2, b2, z2, L, twiddles);
+
+    // Both products are real, so one inverse of C1 + i C2 returns c1 + i c2
+    for (size_t j = 0; j < L; ++j) {
+        z1[j] += Complex(-z2[j].imag(), z2[j].real());
+    }
+    fft_inverse(z1, L, twiddles);
+
+    double scale = 1.0 / (double)L;
+    store_product(z1, count1, scale, false, c1);
+    store_product(z1, count2, scale, true, c2);
+}
+
+void convolve_pair(const std::vector<double>& a1, const std::vector<double>& b1,
+                   const std::vector<double>& a2, const std::vector<double>& b2,
+                   std::vector<double>& c1, std::vector<double>& c2) {
+    size_t count = std::max(a1.size() + b1.size(), a2.size() + b2.size());
+
+    ScratchFrame frame;
+    Complex* twiddles = build_twiddles(fft_length(count), frame);
+    convolve_pair_with(a1, b1, a2, b2, c1, c2, twiddles);
+}
+
+static double norm2(const std::vector<double>& x) {
+    double sum = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        sum += x[i] * x[i];
+    }
+    return std::sqrt(sum);
+}
+
+static double norm1(const std::vector<double>& x) {
+    double sum = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        sum += std::fabs(x[i]);
+    }
+    return sum;
+}
+
+// Direct products round each coefficient in at most min(|a|, |b|) additions.
+// For the FFT the forward and inverse transforms each contribute
+// O(eps log2 L) relative error in the 2-norm, which bounds every coefficient
+// by eps (c log2 L + c') |a|_2 |b|_2; the constants allow for the packed
+// transforms and the directly evaluated roots.
+double convolution_error_bound(const std::vector<double>& a,
+                               const std::vector<double>& b) {
+    double eps = std::numeric_limits<double>::epsilon();
+
+    if (a.empty() || b.empty()) {
+        return 0.0;
+    }
+    if (use_direct(a, b)) {
+        return eps * std::min(a.size(), b.size()) * norm1(a) * norm1(b);
+    }
+
+    double log_L = std::log2((double)fft_length(a.size() + b.size() - 1));
+    return eps * (6.0 * log_L + 8.0) * norm2(a) * norm2(b);
+}
+
+void add_bernoulli_weight(std::vector<double>& prob, int reach, int k, double p) {
+    double q = 1.0 - p;
+
+    for (int w = reach + k; w >= k; --w) {
+        prob[w] = q * prob[w] + p * prob[w - k];
+    }
+    for (int w = k - 1; w >= 0; --w) {
+        prob[w] *= q;
+    }
+}
+
+static void leaf_product(const std::vector<double>& p, int first, int last,
+                         std::vector<double>& prob) {
+    int degree = (last + first) * (last - first + 1) / 2;
+    prob.assign(degree + 1, 0.0);
+    prob[0] = 1.0;
+
+    int reach = 0;
+    for (int k = first; k <= last; ++k) {
+        add_bernoulli_weight(prob, reach, k, p[k]);
+        reach += k;
+    }
+}
+
+static void weight_products(
+    const std::vector<double>& p1, const std::vector<double>& p2,
+    int first, int last,
+    std::vector<double>& c1, std::vector<double>& c2,
+    double& error_bound, const Complex* twiddles
+) {
+    if (last - first < LEAF_WEIGHTS) {
+        leaf_product(p1, first, last, c1);
+        leaf_product(p2, first, last, c2);
+        error_bound += std::numeric_limits<double>::epsilon() * (last - first + 1);
+        return;
+    }
+
+    int mid = first + (last - first) / 2;
+    std::vector<double> low1, low2, high1, high2;
+    weight_products(p1, p2, first, mid, low1, low2, error_bound, twiddles);
+    weight_products(p1, p2, mid + 1, last, high1, high2, error_bound, twiddles);
+
+    error_bound += std::max(convolution_error_bound(low1, high1),
+                            convolution_error_bound(low2, high2));
+    convolve_pair_with(low1, high1, low2, high2, c1, c2, twiddles);
+}
+
+void bernoulli_weight_products(
+    const std::vector<double>& p1, const std::vector<double>& p2,
+    int first, int last,
+    std::vector<double>& c1, std::vector<double>& c2,
+    double& error_bound
+) {
+    // One table serves every product, the last being the longest
+    size_t degree = (size_t)(last + first) * (last - first + 1) / 2;
+
+    ScratchFrame frame;
+    Complex* twiddles = build_twiddles(fft_length(degree + 1), frame);
+    weight_products(p1, p2, first, last, c1, c2, error_bound, twiddles);
+}
@@ -0,0 +1,44 @@
+#ifndef POLYNOMIAL_PRODUCT_H
+#define POLYNOMIAL_PRODUCT_H
+
+#include <vector>
+
+// From about this many steps on the layer of the O(n^3) in-place recursion
+// over W no longer fits in cache and the FFT products are faster
+const int FFT_MIN_STEPS = 1280;
+
+// Multiplies the coefficients prob[0..reach] by (1 - p + p x^k) in place;
+// prob must have room for reach + k + 1 entries
+void add_bernoulli_weight(std::vector<double>& prob, int reach, int k, double p);
+
+// c1 = a1 * b1 and c2 = a2 * b2 for non-negative coefficient vectors. Short
+// factors are multiplied directly. Otherwise each pair of real sequences is
+// packed into one complex FFT and both products come back from a single
+// inverse transform. Negative rounding noise is clamped to zero.
+void convolve_pair(const std::vector<double>& a1, const std::vector<double>& b1,
+                   const std::vector<double>& a2, const std::vector<double>& b2,
+                   std::vector<double>& c1, std::vector<double>& c2);
+
+// A priori bound on the largest absolute rounding error of a coefficient of
+// a * b as computed by convolve_pair, relative to the exact product of the
+// rounded inputs
+double convolution_error_bound(const std::vector<double>& a,
+                               const std::vector<double>& b);
+
+// Coefficients of prod_{k=first..last} (1 - p[k] + p[k] x^k), the law of
+// sum_k k X_k with independent X_k ~ Bernoulli(p[k]), for two probability
+// vectors p1 and p2 at once. The weight range is split in halves, each built
+// recursively, and the halves are multiplied with convolve_pair(); for
+// weights 1..n each result has n(n+1)/2 + 1 entries and the cost is
+// O(n^2 log^2 n). error_bound accumulates a bound on the absolute error of
+// any coefficient of either result: the rounding of each product plus the
+// inherited errors, which propagate with factor 1 because every partial
+// product is a probability vector.
+void bernoulli_weight_products(
+    const std::vector<double>& p1, const std::vector<double>& p2,
+    int first, int last,
+    std::vector<double>& c1, std::vector<double>& c2,
+    double& error_bound
+);
+
+#endif
@@ -0,0 +1,217 @@
+#include <Rcpp.h>
+#include "prepared_model.h"
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+PreparedModel prepare_model(
+    double r, double u, double d,
+    double lambda, double v_u, double v_d, int n,
+    bool arithmetic
+) {
+    PreparedModel model;
+    model.r = r;
+    model.n = n;
+    model.discount = std::pow(r, -n);
+    model.factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+
+    model.geometric = build_geometric_distribution(n, model.factors);
+
+    model.terminal = build_terminal_layer(n, r, model.factors);
+
+    model.has_arithmetic = arithmetic;
+    if (arithmetic) {
+        ScratchFrame frame;
+        model.arithmetic = store_arithmetic_tables(
+            build_arithmetic_tables(n, model.factors, frame));
+    }
+
+    double u_n = std::pow(model.factors.u_tilde, n);
+    double d_n = std::pow(model.factors.d_tilde, n);
+    model.rho_star = std::exp(std::pow(u_n - d_n, 2) / (4.0 * u_n * d_n));
+
+    return model;
+}
+
+double prepared_geometric_price(const PreparedModel& model, double S0, double K, bool is_call) {
+    return quote_geometric(model.geometric, S0, K, 1.0, is_call, model.discount).price;
+}
+
+double prepared_arithmetic_price(const PreparedModel& model, double S0, double K, bool is_call) {
+    double N = model.n + 1;
+    return model.discount / N *
+           sum_arithmetic_payoffs(model.arithmetic.view(), S0, N * K, is_call);
+}
+
+double prepared_european_price(const PreparedModel& model, double S0, double K, bool is_call) {
+    return terminal_value(model.terminal, S0, K, is_call, false);
+}
+
+//' Prepare a Binomial Model with Price Impact
+//'
+//' Tabulates everything about the model that does not depend on the spot or
+//' the strike, so that many \eqn{(S_0, K)} pairs can be priced through
+//' \code{\link{prepared_price_cpp}} without recomputing it.
+//'
+//' @param r Gross risk-free rate per period
+//' @param u Base up factor in CRR model
+//' @param d Base down factor in CRR model
+//' @param lambda Price impact coefficient (non-negative)
+//' @param v_u Hedging volume on up move (non-negative)
+//' @param v_d Hedging volume on down move (non-negative)
+//' @param n Number of time steps (positive integer)
+//' @param arithmetic If TRUE, also build the meet-in-the-middle tables for
+//'   the exact arithmetic price (\eqn{O(2^{n/2})} memory)
+//'
+//' @return External pointer to the prepared model
+//'
+//' @details
+//' The prepared model holds the adjusted factors and discount factor, the
+//' distribution of the normalized geometric average, the terminal
+//' distribution with cumulative sums, the optional arithmetic tables and
+//' \eqn{\rho^*}. All tables are relative to the spot and the model is
+//' read-only once built, so the threads of \code{\link{prepared_price_cpp}}
+//' all read the one instance.
+//'
+//' @export
+// [[Rcpp::export]]
+SEXP prepare_model_cpp(
+    double r, double u, double d,
+    double lambda, double v_u, double v_d, int n,
+    bool arithmetic = true
+) {
+    if (n <= 0) {
+        Rcpp::stop("n must be a positive integer");
+    }
+
+    PreparedModel* model = new PreparedModel(
+        prepare_model(r, u, d, lambda, v_u, v_d, n, arithmetic));
+
+    Rcpp::XPtr<PreparedModel> ptr(model, true);
+    return ptr;
+}
+
+//' Price Many Options Through a Prepared Model
+//'
+//' @param model External pointer from \code{\link{prepare_model_cpp}}
+//' @param S0 Spot of each option (positive)
+//' @param K Strike of each option (positive), same length as \code{S0}
+//' @param option_type "call" or "put" for each option, same length as \code{S0}
+//' @param engine One of "geometric", "arithmetic" or "european"
+//' @param n_threads Threads over the options (default: 1)
+//'
+//' @return Numeric vector of discounted prices
+//'
+//' @details
+//' Geometric and European prices cost one binary search each; the exact
+//' arithmetic price costs one binary search per prefix of the
+//' meet-in-the-middle split. All inputs are checked before pricing starts,
+//' and the options are then split across \code{n_threads} threads that read
+//' the shared model.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::NumericVector prepared_price_cpp(
+    SEXP model, Rcpp::NumericVector S0, Rcpp::NumericVector K,
+    std::vector<std::string> option_type, std::string engine,
+    int n_threads = 1
+) {
+    Rcpp::XPtr<PreparedModel> ptr(model);
+
+    int count = S0.size();
+    if ((int)K.size() != count || (int)option_type.size() != count) {
+        Rcpp::stop("S0, K and option_type must have the same length");
+    }
+    if (n_threads < 1) {
+        Rcpp::stop("n_threads must be a positive integer");
+    }
+
+    double (*price)(const PreparedModel&, double, double, bool);
+    if (engine == "geometric") {
+        price = prepared_geometric_price;
+    } else if (engine == "arithmetic") {
+        if (!ptr->has_arithmetic) {
+            Rcpp::stop("Model was prepared without the arithmetic tables");
+        }
+        price = prepared_arithmetic_price;
+    } else if (engine == "european") {
+        price = prepared_european_price;
+    } else {
+        Rcpp::stop("engine must be one of 'geometric', 'arithmetic' or 'european'");
+    }
+
+    std::vector<char> is_call(count);
+    for (int i = 0; i < count; ++i) {
+        if (option_type[i] != "call" && option_type[i] != "put") {
+            Rcpp::stop("option_type must be either 'call' or 'put'");
+        }
+        is_call[i] = option_type[i] == "call";
+    }
+
+    Rcpp::NumericVector prices(count);
+    const PreparedModel& prepared = *ptr;
+    const double* spot = S0.begin();
+    const double* strike = K.begin();
+    double* out = prices.begin();
+
+    #pragma omp parallel for num_threads(n_threads) schedule(static)
+    for (int i = 0; i < count; ++i) {
+        out[i] = price(prepared, spot[i], strike[i], is_call[i] != 0);
+    }
+
+    return prices;
+}
+
+//' Arithmetic Asian Bounds Through a Prepared Model
+//'
+//' @param model External pointer from \code{\link{prepare_model_cpp}}
+//' @param S0 Spot of each option (positive)
+//' @param K Strike of each option (positive), same length as \code{S0}
+//' @param option_type "call" or "put" for each option, same length as \code{S0}
+//'
+//' @return List of vectors \code{lower_bound}, \code{upper_bound} and
+//'   \code{EQ_G}, plus the scalar \code{rho_star}, as in
+//'   \code{\link{arithmetic_asian_bounds_cpp}}
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List prepared_bounds_cpp(
+    SEXP model, Rcpp::NumericVector S0, Rcpp::NumericVector K,
+    std::vector<std::string> option_type
+) {
+    Rcpp::XPtr<PreparedModel> ptr(model);
+
+    int count = S0.size();
+    if ((int)K.size() != count || (int)option_type.size() != count) {
+        Rcpp::stop("S0, K and option_type must have the same length");
+    }
+
+    const GeometricDistribution& dist = ptr->geometric;
+    double relative_EQ_G = dist.cum_qh[dist.size()];
+
+    Rcpp::NumericVector lower_bound(count);
+    Rcpp::NumericVector upper_bound(count);
+    Rcpp::NumericVector EQ_G(count);
+
+    for (int i = 0; i < count; ++i) {
+        if (option_type[i] != "call" && option_type[i] != "put") {
+            Rcpp::stop("option_type must be either 'call' or 'put'");
+        }
+        lower_bound[i] = prepared_geometric_price(*ptr, S0[i], K[i],
+                                                  option_type[i] == "call");
+        EQ_G[i] = S0[i] * relative_EQ_G;
+        upper_bound[i] = lower_bound[i] +
+                         ptr->discount * (ptr->rho_star - 1.0) * EQ_G[i];
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("lower_bound") = lower_bound,
+        Rcpp::Named("upper_bound") = upper_bound,
+        Rcpp::Named("EQ_G") = EQ_G,
+        Rcpp::Named("rho_star") = ptr->rho_star
+    );
+}
@@ -0,0 +1,43 @@
+#ifndef PREPARED_MODEL_H
+#define PREPARED_MODEL_H
+
+#include "utils.h"
+#include "path_enumeration.h"
+#include "geometric_distribution.h"
+#include "terminal_distribution.h"
+#include <vector>
+
+// Everything about (r, u, d, lambda, v_u, v_d, n) that does not depend on the
+// spot or the strike, tabulated once in contiguous arrays. A prepared model
+// is never modified after prepare_model() returns, so any number of threads
+// may price through the same instance.
+struct PreparedModel {
+    double r;
+    int n;
+    double discount;
+    AdjustedFactors factors;
+
+    GeometricDistribution geometric;
+
+    TerminalLayer terminal;
+
+    bool has_arithmetic;
+    StoredArithmeticTables arithmetic;
+
+    double rho_star;
+};
+
+PreparedModel prepare_model(
+    double r, double u, double d,
+    double lambda, double v_u, double v_d, int n,
+    bool arithmetic
+);
+
+// Discounted prices for one (S0, K). They do not call back into R, so
+// threads may run them concurrently; the arithmetic price needs a model
+// prepared with the arithmetic tables.
+double prepared_geometric_price(const PreparedModel& model, double S0, double K, bool is_call);
+double prepared_arithmetic_price(const PreparedModel& model, double S0, double K, bool is_call);
+double prepared_european_price(const PreparedModel& model, double S0, double K, bool is_call);
+
+#endif
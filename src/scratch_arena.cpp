@@ -0,0 +1,159 @@
+#include <Rcpp.h>
+#include "scratch_arena.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// 64-byte alignment keeps every array on its own cache lines and satisfies
+// the widest vector loads of the path kernel
+static const size_t BLOCK_ALIGN = 64;
+static const size_t MIN_BLOCK_BYTES = 1 << 16;
+
+static std::atomic<long long> heap_allocations(0);
+
+static char* allocate_block(size_t size) {
+    void* data = ::operator new(size);
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<char*>(data);
+}
+
+ScratchArena::ScratchArena() : block_(0), offset_(0), depth_(0) {}
+
+ScratchArena::~ScratchArena() {
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        ::operator delete(blocks_[i].data);
+    }
+}
+
+void* ScratchArena::allocate(size_t bytes, size_t align) {
+    if (align < BLOCK_ALIGN) {
+        align = BLOCK_ALIGN;
+    }
+
+    while (true) {
+        if (block_ < blocks_.size()) {
+            Block& block = blocks_[block_];
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+            size_t start = ((base + offset_ + align - 1) & ~(uintptr_t)(align - 1)) - base;
+
+            if (start + bytes <= block.size) {
+                offset_ = start + bytes;
+                return block.data + start;
+            }
+
+            // An unused block that is too small is replaced by a larger one
+            if (offset_ == 0) {
+                ::operator delete(block.data);
+                block.size = std::max(bytes + align, 2 * block.size);
+                block.data = allocate_block(block.size);
+                continue;
+            }
+
+            ++block_;
+            offset_ = 0;
+            continue;
+        }
+
+        size_t last = blocks_.empty() ? MIN_BLOCK_BYTES : 2 * blocks_.back().size;
+        Block block;
+        block.size = std::max(bytes + align, last);
+        block.data = allocate_block(block.size);
+        blocks_.push_back(block);
+    }
+}
+
+ScratchArena::Mark ScratchArena::mark() const {
+    Mark m;
+    m.block = block_;
+    m.offset = offset_;
+    return m;
+}
+
+void ScratchArena::release(const Mark& m) {
+    block_ = m.block;
+    offset_ = m.offset;
+}
+
+void ScratchArena::enter() {
+    ++depth_;
+}
+
+void ScratchArena::leave() {
+    if (--depth_ == 0) {
+        trim(SCRATCH_RETAIN_BYTES);
+    }
+}
+
+// Frees unused blocks from the largest (last) down until at most keep_bytes
+// remain reserved
+void ScratchArena::trim(size_t keep_bytes) {
+    size_t total = reserved_bytes();
+    while (!blocks_.empty() && total > keep_bytes) {
+        size_t last = blocks_.size() - 1;
+        if (last < block_ || (last == block_ && offset_ > 0)) {
+            break;
+        }
+        total -= blocks_[last].size;
+        ::operator delete(blocks_[last].data);
+        blocks_.pop_back();
+    }
+    if (block_ > blocks_.size()) {
+        block_ = blocks_.size();
+        offset_ = 0;
+    }
+}
+
+size_t ScratchArena::reserved_bytes() const {
+    size_t total = 0;
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        total += blocks_[i].size;
+    }
+    return total;
+}
+
+// Bytes below the current position, including alignment padding and the
+// unused tails of the blocks already passed
+size_t ScratchArena::used_bytes() const {
+    size_t total = 0;
+    for (size_t i = 0; i < block_ && i < blocks_.size(); ++i) {
+        total += blocks_[i].size;
+    }
+    return total + offset_;
+}
+
+ScratchArena& thread_scratch_arena() {
+    static thread_local ScratchArena arena;
+    return arena;
+}
+
+long long scratch_heap_allocations() {
+    return heap_allocations.load(std::memory_order_relaxed);
+}
+
+//' Scratch Arena Statistics
+//'
+//' Reports the per-thread scratch arenas that hold the temporaries of the
+//' pricing engines (path tables, simulated paths, lane buffers).
+//'
+//' @return List with \code{heap_allocations}, the number of blocks the
+//'   arenas of all threads have obtained from the heap since the package was
+//'   loaded, \code{reserved_bytes}, the size of the calling thread's arena,
+//'   \code{used_bytes}, the part of it currently handed out (0 between
+//'   calls), and \code{retain_bytes}, the most a thread keeps reserved
+//'   between calls. Once the largest problem within that cap has been
+//'   priced, repeated calls leave \code{heap_allocations} unchanged; this
+//'   covers the arena-served buffers only, not results or objects kept
+//'   beyond the call.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List scratch_arena_stats_cpp() {
+    return Rcpp::List::create(
+        Rcpp::Named("heap_allocations") = (double)scratch_heap_allocations(),
+        Rcpp::Named("reserved_bytes") = (double)thread_scratch_arena().reserved_bytes(),
+        Rcpp::Named("used_bytes") = (double)thread_scratch_arena().used_bytes(),
+        Rcpp::Named("retain_bytes") = (double)SCRATCH_RETAIN_BYTES
+    );
+}
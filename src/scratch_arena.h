@@ -0,0 +1,88 @@
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+// Per-thread bump allocator for engine temporaries (path tables, lane
+// buffers, simulated paths). Memory is handed out by advancing an offset
+// and given back by rewinding it. When a thread's outermost frame unwinds,
+// blocks beyond SCRATCH_RETAIN_BYTES are returned to the heap and the rest
+// are kept for the next call, so repeated pricing of problems that fit the
+// cap needs no further heap allocation for the buffers served from the
+// arena, and a one-off large call does not stay resident. Results kept
+// beyond the call (distributions, prepared models, R vectors) are
+// allocated as usual.
+const size_t SCRATCH_RETAIN_BYTES = (size_t)32 << 20;
+
+class ScratchArena {
+public:
+    struct Mark {
+        size_t block;
+        size_t offset;
+    };
+
+    ScratchArena();
+    ~ScratchArena();
+
+    void* allocate(size_t bytes, size_t align);
+
+    Mark mark() const;
+    void release(const Mark& m);
+
+    // Frame nesting; leaving the outermost frame trims the arena
+    void enter();
+    void leave();
+
+    size_t reserved_bytes() const;
+    size_t used_bytes() const;
+
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks_;
+    size_t block_;
+    size_t offset_;
+    int depth_;
+
+    void trim(size_t keep_bytes);
+
+    ScratchArena(const ScratchArena&);
+    ScratchArena& operator=(const ScratchArena&);
+};
+
+// The calling thread's arena
+ScratchArena& thread_scratch_arena();
+
+// Number of blocks ever obtained from the heap by any thread's arena
+long long scratch_heap_allocations();
+
+// Scope on the calling thread's arena: everything allocated through the
+// frame is released when it goes out of scope (including by exception)
+class ScratchFrame {
+public:
+    ScratchFrame() : arena_(thread_scratch_arena()), mark_(arena_.mark()) {
+        arena_.enter();
+    }
+    ~ScratchFrame() {
+        arena_.release(mark_);
+        arena_.leave();
+    }
+
+    template <typename T>
+    T* allocate(size_t count) {
+        return static_cast<T*>(arena_.allocate(count * sizeof(T), alignof(T)));
+    }
+
+private:
+    ScratchArena& arena_;
+    ScratchArena::Mark mark_;
+
+    ScratchFrame(const ScratchFrame&);
+    ScratchFrame& operator=(const ScratchFrame&);
+};
+
+#endif
@@ -0,0 +1,134 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include <Rcpp.h>
+#include "spill_file.h"
+#include <vector>
+#include <algorithm>
+
+#ifdef _WIN32
+
+SpillFile::SpillFile() : data_(NULL), bytes_(0), file_(INVALID_HANDLE_VALUE),
+                         mapping_(NULL) {}
+
+SpillFile::~SpillFile() {
+    if (data_ != NULL) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_ != NULL) {
+        CloseHandle(mapping_);
+    }
+    if (file_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(file_);
+    }
+}
+
+double* SpillFile::map(size_t count, const std::string& dir) {
+    bytes_ = count * sizeof(double);
+
+    char path[MAX_PATH];
+    if (GetTempFileNameA(dir.c_str(), "aop", 0, path) == 0) {
+        Rcpp::stop("cannot create a scratch file in '" + dir + "'");
+    }
+
+    file_ = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL,
+                        CREATE_ALWAYS,
+                        FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE,
+                        NULL);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        DeleteFileA(path);
+        Rcpp::stop("cannot open scratch file '" + std::string(path) + "'");
+    }
+
+    unsigned long long size = bytes_;
+    mapping_ = CreateFileMappingA(file_, NULL, PAGE_READWRITE,
+                                  (DWORD)(size >> 32), (DWORD)(size & 0xffffffffULL),
+                                  NULL);
+    if (mapping_ == NULL) {
+        Rcpp::stop("cannot reserve the scratch file in '" + dir + "'");
+    }
+
+    data_ = MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, bytes_);
+    if (data_ == NULL) {
+        Rcpp::stop("cannot map the scratch file");
+    }
+
+    return static_cast<double*>(data_);
+}
+
+#else
+
+SpillFile::SpillFile() : data_(NULL), bytes_(0), fd_(-1) {}
+
+SpillFile::~SpillFile() {
+    if (data_ != NULL) {
+        munmap(data_, bytes_);
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+double* SpillFile::map(size_t count, const std::string& dir) {
+    bytes_ = count * sizeof(double);
+
+    std::string name = dir + "/AsianOptPI-XXXXXX";
+    std::vector<char> path(name.begin(), name.end());
+    path.push_back('\0');
+
+    fd_ = mkstemp(&path[0]);
+    if (fd_ < 0) {
+        Rcpp::stop("cannot create a scratch file in '" + dir + "': " +
+                   std::strerror(errno));
+    }
+    unlink(&path[0]);
+
+    // Reserving the blocks up front turns a full disk into an error here
+    // rather than a SIGBUS on first touch of a sparse page. Without
+    // posix_fallocate the file is filled with zeros, which writes every page
+    // once but also reserves it.
+#ifdef __linux__
+    int status = posix_fallocate(fd_, 0, (off_t)bytes_);
+#else
+    int status = 0;
+    std::vector<char> zeros((size_t)1 << 20, 0);
+    for (size_t written = 0; written < bytes_ && status == 0;) {
+        size_t chunk = std::min(zeros.size(), bytes_ - written);
+        ssize_t w = write(fd_, &zeros[0], chunk);
+        if (w > 0) {
+            written += (size_t)w;
+        } else if (w < 0 && errno != EINTR) {
+            status = errno;
+        } else if (w == 0) {
+            status = ENOSPC;
+        }
+    }
+#endif
+    if (status != 0) {
+        Rcpp::stop("cannot reserve the scratch file in '" + dir + "': " +
+                   std::strerror(status));
+    }
+
+    void* data = mmap(NULL, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED) {
+        Rcpp::stop(std::string("cannot map the scratch file: ") +
+                   std::strerror(errno));
+    }
+    data_ = data;
+
+    madvise(data_, bytes_, MADV_SEQUENTIAL);
+
+    return static_cast<double*>(data_);
+}
+
+#endif
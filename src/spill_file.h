@@ -0,0 +1,35 @@
+#ifndef SPILL_FILE_H
+#define SPILL_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Array of doubles backed by a memory-mapped scratch file, for DP layers that
+// do not fit the caller's memory budget. The engines sweep their layers
+// sequentially, so the kernel streams the pages to and from disk and a
+// problem larger than RAM runs at disk bandwidth instead of failing to
+// allocate. The file has no name once mapped (POSIX) or is deleted when the
+// mapping is closed (Windows), so nothing is left behind on error.
+class SpillFile {
+public:
+    SpillFile();
+    ~SpillFile();
+
+    // Maps count doubles in a new scratch file under dir
+    double* map(size_t count, const std::string& dir);
+
+private:
+    void* data_;
+    size_t bytes_;
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#else
+    int fd_;
+#endif
+
+    SpillFile(const SpillFile&);
+    SpillFile& operator=(const SpillFile&);
+};
+
+#endif
@@ -0,0 +1,304 @@
+#include <Rcpp.h>
+#include "utils.h"
+#include "path_kernel.h"
+#include "scratch_arena.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// Reading a row of the DP at an accumulated gain between grid points
+static const int TARF_INTERP_LINEAR = 0;
+static const int TARF_INTERP_NEAREST = 1;
+
+// Cash flow of a fixing at S, c = sign (S - K) leveraged when negative, and
+// the gain it accumulates, its positive part
+static inline void tarf_fixing(const TarfTerms& terms, double S,
+                               double& cash, double& gain) {
+    double diff = terms.sign * (S - terms.K);
+    gain = std::max(0.0, diff);
+    cash = diff > 0.0 ? diff : terms.leverage * diff;
+}
+
+struct TarfValue {
+    double price;
+    double knockout_prob;
+};
+
+// Backward induction over (up-count j, accumulated gain a) on the grid
+// a_i = i * target / (M - 1). A fixing's gain depends only on the node, so
+// it moves every grid point by the same number of cells and the
+// continuation is a fixed two-point stencil per node. Value rows are
+// discounted; knock-out probability rows are not.
+static TarfValue tarf_backward(
+    double S0, int n, const AdjustedFactors& factors, const TarfTerms& terms,
+    int M, int interpolation
+) {
+    double h = terms.target / (M - 1);
+    double log_S0 = std::log(S0);
+    double log_u = std::log(factors.u_tilde);
+    double log_d = std::log(factors.d_tilde);
+    double p = factors.p_adj;
+
+    size_t layer = (size_t)(n + 1) * M;
+    ScratchFrame frame;
+    double* value = frame.allocate<double>(layer);
+    double* out = frame.allocate<double>(layer);
+    double* next_value = frame.allocate<double>(layer);
+    double* next_out = frame.allocate<double>(layer);
+    std::fill(next_value, next_value + layer, 0.0);
+    std::fill(next_out, next_out + layer, 0.0);
+
+    for (int t = n - 1; t >= 0; --t) {
+        for (int j = 0; j <= t; ++j) {
+            double* row = value + (size_t)j * M;
+            double* row_out = out + (size_t)j * M;
+            std::fill(row, row + M, 0.0);
+            std::fill(row_out, row_out + M, 0.0);
+
+            for (int b = 0; b < 2; ++b) {
+                int child = j + b;
+                double prob = b ? p : 1.0 - p;
+                double weight = prob * terms.discount;
+                double S = std::exp(log_S0 + child * log_u + (t + 1 - child) * log_d);
+                double cash, gain;
+                tarf_fixing(terms, S, cash, gain);
+
+                const double* child_value = next_value + (size_t)child * M;
+                const double* child_out = next_out + (size_t)child * M;
+
+                // a_i + gain sits at cell i + shift + frac. States from
+                // first_out on reach the target at this fixing.
+                double offset = gain / h;
+                int shift = (int)std::floor(offset);
+                double frac = offset - shift;
+                if (interpolation == TARF_INTERP_NEAREST) {
+                    shift += frac >= 0.5 ? 1 : 0;
+                    frac = 0.0;
+                }
+                int first_out = 0;
+                while (first_out < M && first_out * h + gain < terms.target) {
+                    ++first_out;
+                }
+
+                for (int i = 0; i < first_out; ++i) {
+                    const double* v = child_value + i + shift;
+                    const double* o = child_out + i + shift;
+                    double continuation = frac > 0.0 ? v[0] + frac * (v[1] - v[0]) : v[0];
+                    double continuation_out = frac > 0.0 ? o[0] + frac * (o[1] - o[0]) : o[0];
+                    row[i] += weight * (cash + continuation);
+                    row_out[i] += prob * continuation_out;
+                }
+
+                for (int i = first_out; i < M; ++i) {
+                    double knockout_cash = cash;
+                    if (terms.knockout == TARF_KNOCKOUT_CAPPED) {
+                        knockout_cash = terms.target - i * h;
+                    } else if (terms.knockout == TARF_KNOCKOUT_NONE) {
+                        knockout_cash = 0.0;
+                    }
+                    row[i] += weight * knockout_cash;
+                    row_out[i] += prob;
+                }
+            }
+        }
+
+        std::swap(value, next_value);
+        std::swap(out, next_out);
+    }
+
+    // The step-0 row is now in next_value and next_out
+    double x = terms.accrued / h;
+    int lo = std::min(M - 2, (int)std::floor(x));
+    double frac = x - lo;
+    if (interpolation == TARF_INTERP_NEAREST) {
+        lo = std::min(M - 1, (int)std::floor(x + 0.5));
+        frac = 0.0;
+    }
+
+    TarfValue result;
+    result.price = next_value[lo];
+    result.knockout_prob = next_out[lo];
+    if (frac > 0.0) {
+        result.price += frac * (next_value[lo + 1] - next_value[lo]);
+        result.knockout_prob += frac * (next_out[lo + 1] - next_out[lo]);
+    }
+    return result;
+}
+
+//' Price a Target Accrual Forward (TARF) with Price Impact
+//'
+//' Values a TARF on the binomial tree with price impact, either by
+//' backward induction over (level, accumulated gain) with the gain
+//' discretized on a grid, or by Monte Carlo through the path lane kernel.
+//'
+//' @param S0 Initial stock price (positive)
+//' @param K Strike of every fixing (positive)
+//' @param r Gross risk-free rate per period
+//' @param u Base up factor in CRR model
+//' @param d Base down factor in CRR model
+//' @param lambda Price impact coefficient (non-negative)
+//' @param v_u Hedging volume on up move (non-negative)
+//' @param v_d Hedging volume on down move (non-negative)
+//' @param n Number of fixings, one per step (positive integer)
+//' @param target Accumulated gain that knocks the contract out (positive)
+//' @param leverage Multiple applied to losing fixings (default: 2)
+//' @param option_type "call" (buy at K) or "put" (sell at K)
+//' @param knockout Payment of the knock-out fixing: "full", "capped" (only
+//'   up to the target) or "none"
+//' @param accrued Gain accumulated before \code{S0} (default: 0)
+//' @param method "dp" or "mc"
+//' @param grid_points Number of points of the accumulated gain grid
+//' @param interpolation "linear" or "nearest" reading of the grid
+//' @param n_simulations Number of Monte Carlo paths
+//' @param seed Random seed for reproducibility (default: -1 for no seed)
+//'
+//' @return List with the discounted \code{price} to the holder, its
+//'   \code{std_error} (0 for the DP), the \code{knockout_prob}, and for
+//'   Monte Carlo the \code{expected_knockout_step} given a knock-out, and
+//'   \code{u_tilde}, \code{d_tilde} and \code{p_adj}
+//'
+//' @details
+//' Fixing \eqn{t = 1..n} pays \eqn{c_t = \pm(S_t - K)} when positive and
+//' \code{leverage} times it when negative, at step \eqn{t}. The gains
+//' \eqn{\max(0, c_t)} accumulate, and the fixing at which they reach
+//' \code{target} ends the contract. The DP carries the value and the
+//' knock-out probability of every state (up-count, accumulated gain) back
+//' from maturity on \code{grid_points} gain levels from 0 to the target.
+//' Knock-outs are decided exactly; only the continuation is read between
+//' grid points, linearly or at the nearest point, for \eqn{O(n^2 M)} time
+//' and \eqn{O(n M)} memory.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List price_tarf_cpp(
+    double S0, double K, double r, double u, double d,
+    double lambda, double v_u, double v_d, int n,
+    double target, double leverage = 2.0,
+    std::string option_type = "call",
+    std::string knockout = "full",
+    double accrued = 0.0,
+    std::string method = "dp",
+    int grid_points = 2001,
+    std::string interpolation = "linear",
+    int n_simulations = 100000,
+    int seed = -1
+) {
+    if (n <= 0) {
+        Rcpp::stop("n must be a positive integer");
+    }
+    if (!(S0 > 0) || !(K > 0)) {
+        Rcpp::stop("S0 and K must be positive");
+    }
+    if (!(target > 0)) {
+        Rcpp::stop("target must be positive");
+    }
+    if (!(leverage >= 0)) {
+        Rcpp::stop("leverage must be non-negative");
+    }
+    if (!(accrued >= 0 && accrued < target)) {
+        Rcpp::stop("accrued must be in [0, target)");
+    }
+    if (option_type != "call" && option_type != "put") {
+        Rcpp::stop("option_type must be either 'call' or 'put'");
+    }
+    if (knockout != "full" && knockout != "capped" && knockout != "none") {
+        Rcpp::stop("knockout must be one of 'full', 'capped' or 'none'");
+    }
+    if (method != "dp" && method != "mc") {
+        Rcpp::stop("method must be either 'dp' or 'mc'");
+    }
+    if (interpolation != "linear" && interpolation != "nearest") {
+        Rcpp::stop("interpolation must be either 'linear' or 'nearest'");
+    }
+    if (method == "dp" && grid_points < 2) {
+        Rcpp::stop("grid_points must be at least 2");
+    }
+    if (method == "mc" && n_simulations <= 0) {
+        Rcpp::stop("n_simulations must be positive");
+    }
+
+    AdjustedFactors factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+
+    TarfTerms terms;
+    terms.K = K;
+    terms.target = target;
+    terms.leverage = leverage;
+    terms.sign = (option_type == "call") ? 1.0 : -1.0;
+    terms.knockout = (knockout == "full") ? TARF_KNOCKOUT_FULL
+                   : (knockout == "capped") ? TARF_KNOCKOUT_CAPPED
+                   : TARF_KNOCKOUT_NONE;
+    terms.accrued = accrued;
+    terms.discount = 1.0 / r;
+
+    if (method == "dp") {
+        TarfValue value = tarf_backward(
+            S0, n, factors, terms, grid_points,
+            interpolation == "linear" ? TARF_INTERP_LINEAR : TARF_INTERP_NEAREST);
+
+        return Rcpp::List::create(
+            Rcpp::Named("price") = value.price,
+            Rcpp::Named("std_error") = 0.0,
+            Rcpp::Named("knockout_prob") = value.knockout_prob,
+            Rcpp::Named("expected_knockout_step") = NA_REAL,
+            Rcpp::Named("u_tilde") = factors.u_tilde,
+            Rcpp::Named("d_tilde") = factors.d_tilde,
+            Rcpp::Named("p_adj") = factors.p_adj
+        );
+    }
+
+    if (seed >= 0) {
+        Rcpp::Environment base_env("package:base");
+        Rcpp::Function set_seed = base_env["set.seed"];
+        set_seed(seed);
+    }
+
+    ScratchFrame frame;
+    unsigned char* moves = frame.allocate<unsigned char>((size_t)n * PATH_LANES);
+    std::fill(moves, moves + (size_t)n * PATH_LANES, 0);
+    TarfLanes lanes;
+
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    double knockouts = 0.0;
+    double knockout_steps = 0.0;
+
+    GetRNGstate();
+
+    for (int first = 0; first < n_simulations; first += PATH_LANES) {
+        int count = std::min(PATH_LANES, n_simulations - first);
+
+        for (int l = 0; l < count; ++l) {
+            for (int i = 0; i < n; ++i) {
+                moves[(size_t)i * PATH_LANES + l] =
+                    (R::runif(0.0, 1.0) < factors.p_adj) ? 1 : 0;
+            }
+        }
+
+        evaluate_tarf_lanes(moves, n, S0, factors, terms, lanes);
+
+        for (int l = 0; l < count; ++l) {
+            sum += lanes.value[l];
+            sum_sq += lanes.value[l] * lanes.value[l];
+            if (lanes.knockout[l] > 0.0) {
+                knockouts += 1.0;
+                knockout_steps += lanes.knockout[l];
+            }
+        }
+    }
+
+    PutRNGstate();
+
+    double price = sum / n_simulations;
+    double variance = sum_sq / n_simulations - price * price;
+
+    return Rcpp::List::create(
+        Rcpp::Named("price") = price,
+        Rcpp::Named("std_error") = std::sqrt(std::max(0.0, variance) / n_simulations),
+        Rcpp::Named("knockout_prob") = knockouts / n_simulations,
+        Rcpp::Named("expected_knockout_step") =
+            knockouts > 0.0 ? knockout_steps / knockouts : NA_REAL,
+        Rcpp::Named("u_tilde") = factors.u_tilde,
+        Rcpp::Named("d_tilde") = factors.d_tilde,
+        Rcpp::Named("p_adj") = factors.p_adj
+    );
+}
@@ -0,0 +1,189 @@
+#include <Rcpp.h>
+#include "terminal_distribution.h"
+#include "binomial_cache.h"
+#include <cmath>
+#include <algorithm>
+
+TerminalLayer build_terminal_layer(int steps, double r, const AdjustedFactors& factors) {
+    TerminalLayer layer;
+    layer.steps = steps;
+    layer.discount = std::pow(r, -steps);
+
+    layer.rel.resize(steps + 1);
+    layer.cum_q.assign(steps + 2, 0.0);
+    layer.cum_qs.assign(steps + 2, 0.0);
+
+    double log_p = std::log(factors.p_adj);
+    double log_q = std::log(1.0 - factors.p_adj);
+    double log_u = std::log(factors.u_tilde);
+    double log_d = std::log(factors.d_tilde);
+
+    for (int k = 0; k <= steps; ++k) {
+        double rel = std::exp(k * log_u + (steps - k) * log_d);
+        double prob = std::exp(log_binomial_weight(steps, k, log_p, log_q));
+
+        layer.rel[k] = rel;
+        layer.cum_q[k + 1] = layer.cum_q[k] + prob;
+        layer.cum_qs[k + 1] = layer.cum_qs[k] + prob * rel;
+    }
+
+    return layer;
+}
+
+double terminal_value(
+    const TerminalLayer& layer, double S, double K,
+    bool is_call, bool is_digital
+) {
+    const std::vector<double>& rel = layer.rel;
+    double threshold = K / S;
+
+    size_t m = rel.size();
+    double value;
+
+    if (is_call) {
+        size_t idx = std::upper_bound(rel.begin(), rel.end(), threshold) - rel.begin();
+        double q_above = layer.cum_q[m] - layer.cum_q[idx];
+        value = is_digital ? q_above
+                           : S * (layer.cum_qs[m] - layer.cum_qs[idx]) - K * q_above;
+    } else {
+        size_t idx = std::lower_bound(rel.begin(), rel.end(), threshold) - rel.begin();
+        value = is_digital ? layer.cum_q[idx]
+                           : K * layer.cum_q[idx] - S * layer.cum_qs[idx];
+    }
+
+    return layer.discount * std::max(0.0, value);
+}
+
+// Terminal layers n, n-1 and n-2 steps ahead of the spot: the first prices
+// the options, the others value them at the step-1 and step-2 nodes for the
+// replicating-portfolio delta and gamma
+struct TerminalDistribution {
+    double S0;
+    int n;
+    AdjustedFactors factors;
+    std::vector<TerminalLayer> layers;
+};
+
+//' Build a Terminal Distribution for European Strike Ladders
+//'
+//' Tabulates the terminal distribution of the impacted binomial tree from
+//' \code{S0} once, so that any number of strikes can be priced with
+//' \code{\link{terminal_ladder_cpp}}.
+//'
+//' @param S0 Initial stock price (positive)
+//' @param r Gross risk-free rate per period
+//' @param u Base up factor in CRR model
+//' @param d Base down factor in CRR model
+//' @param lambda Price impact coefficient (non-negative)
+//' @param v_u Hedging volume on up move (non-negative)
+//' @param v_d Hedging volume on down move (non-negative)
+//' @param n Number of time steps (positive integer)
+//'
+//' @return External pointer to the distribution
+//'
+//' @details
+//' Three layers are stored: the \eqn{n}-step distribution seen from the
+//' spot and the \eqn{(n-1)}- and \eqn{(n-2)}-step distributions seen from the
+//' nodes after one and two steps, each with cumulative sums of \eqn{q_k} and
+//' \eqn{q_k S_n / S}. The build is \eqn{O(n)}.
+//'
+//' @export
+// [[Rcpp::export]]
+SEXP terminal_distribution_cpp(
+    double S0, double r, double u, double d,
+    double lambda, double v_u, double v_d, int n
+) {
+    if (n <= 0) {
+        Rcpp::stop("n must be a positive integer");
+    }
+    if (!(S0 > 0)) {
+        Rcpp::stop("S0 must be positive");
+    }
+
+    TerminalDistribution* dist = new TerminalDistribution();
+    Rcpp::XPtr<TerminalDistribution> ptr(dist, true);
+
+    dist->S0 = S0;
+    dist->n = n;
+    dist->factors = compute_adjusted_factors(r, u, d, lambda, v_u, v_d);
+
+    for (int j = 0; j <= 2 && j <= n; ++j) {
+        dist->layers.push_back(build_terminal_layer(n - j, r, dist->factors));
+    }
+
+    return ptr;
+}
+
+//' Price a European Strike Ladder from a Terminal Distribution
+//'
+//' @param dist External pointer from \code{\link{terminal_distribution_cpp}}
+//' @param K Strike of each option (positive)
+//' @param option_type One of "call", "put", "digital_call" or "digital_put"
+//'   for each option, same length as \code{K}
+//'
+//' @return List of vectors \code{price}, \code{delta} and \code{gamma}
+//'
+//' @details
+//' Each value is one binary search over a stored layer. The delta and gamma
+//' are those of the replicating portfolio on the tree,
+//' \deqn{\Delta = \frac{V_u - V_d}{S_0(\tilde{u} - \tilde{d})}, \quad
+//' \Gamma = \frac{\Delta_u - \Delta_d}{S_0(\tilde{u}^2 - \tilde{d}^2)/2},}
+//' with \eqn{V_u, V_d} the values after one step and \eqn{\Delta_u, \Delta_d}
+//' the deltas after one step. The gamma is \code{NA} when \eqn{n < 2}.
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List terminal_ladder_cpp(
+    SEXP dist, Rcpp::NumericVector K, std::vector<std::string> option_type
+) {
+    Rcpp::XPtr<TerminalDistribution> ptr(dist);
+
+    int count = K.size();
+    if ((int)option_type.size() != count) {
+        Rcpp::stop("K and option_type must have the same length");
+    }
+
+    double S0 = ptr->S0;
+    double u = ptr->factors.u_tilde;
+    double d = ptr->factors.d_tilde;
+    bool has_gamma = ptr->layers.size() == 3;
+
+    Rcpp::NumericVector price(count);
+    Rcpp::NumericVector delta(count);
+    Rcpp::NumericVector gamma(count);
+
+    for (int i = 0; i < count; ++i) {
+        const std::string& type = option_type[i];
+        bool is_digital = (type == "digital_call" || type == "digital_put");
+        bool is_call = (type == "call" || type == "digital_call");
+        if (!is_call && type != "put" && type != "digital_put") {
+            Rcpp::stop("option_type must be one of 'call', 'put', 'digital_call' or 'digital_put'");
+        }
+
+        price[i] = terminal_value(ptr->layers[0], S0, K[i], is_call, is_digital);
+
+        const TerminalLayer& one = ptr->layers[1];
+        double V_u = terminal_value(one, S0 * u, K[i], is_call, is_digital);
+        double V_d = terminal_value(one, S0 * d, K[i], is_call, is_digital);
+        delta[i] = (V_u - V_d) / (S0 * (u - d));
+
+        if (has_gamma) {
+            const TerminalLayer& two = ptr->layers[2];
+            double V_uu = terminal_value(two, S0 * u * u, K[i], is_call, is_digital);
+            double V_ud = terminal_value(two, S0 * u * d, K[i], is_call, is_digital);
+            double V_dd = terminal_value(two, S0 * d * d, K[i], is_call, is_digital);
+
+            double delta_u = (V_uu - V_ud) / (S0 * u * (u - d));
+            double delta_d = (V_ud - V_dd) / (S0 * d * (u - d));
+            gamma[i] = (delta_u - delta_d) / (0.5 * S0 * (u * u - d * d));
+        } else {
+            gamma[i] = NA_REAL;
+        }
+    }
+
+    return Rcpp::List::create(
+        Rcpp::Named("price") = price,
+        Rcpp::Named("delta") = delta,
+        Rcpp::Named("gamma") = gamma
+    );
+}
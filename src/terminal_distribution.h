@@ -0,0 +1,30 @@
+#ifndef TERMINAL_DISTRIBUTION_H
+#define TERMINAL_DISTRIBUTION_H
+
+#include "utils.h"
+#include <vector>
+
+// Terminal distribution `steps` steps ahead of a node, relative to the
+// node's price: S_steps / S = u_tilde^k d_tilde^(steps-k), ascending in k,
+// with cumulative sums of the binomial probabilities q_k and of q_k S_steps/S
+// (cum_*[i] covers the first i)
+struct TerminalLayer {
+    int steps;
+    double discount;  // r^-steps
+    std::vector<double> rel;
+    std::vector<double> cum_q;
+    std::vector<double> cum_qs;
+};
+
+// O(steps) build from log-space binomial weights
+TerminalLayer build_terminal_layer(int steps, double r, const AdjustedFactors& factors);
+
+// Discounted value at a node with price S by one binary search. Vanilla
+// payoffs are max(0, S_T - K) or max(0, K - S_T); digital payoffs pay 1 when
+// S_T > K (call) or S_T < K (put).
+double terminal_value(
+    const TerminalLayer& layer, double S, double K,
+    bool is_call, bool is_digital
+);
+
+#endif
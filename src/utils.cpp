@@ -18,6 +18,41 @@ AdjustedFactors compute_adjusted_factors(
     return factors;
 }
 
+Seasoning make_seasoning(
+    int n_fixed, double fixed_sum, double fixed_log_sum,
+    double fixed_min, double fixed_max
+) {
+    if (n_fixed < 0) {
+        Rcpp::stop("n_fixed must be non-negative");
+    }
+
+    if (n_fixed == 0 && (fixed_sum != 0.0 || fixed_log_sum != 0.0)) {
+        Rcpp::stop("fixed_sum and fixed_log_sum must be 0 when n_fixed is 0");
+    }
+
+    if (n_fixed > 0) {
+        if (!(fixed_sum > 0.0) || !R_FINITE(fixed_sum) || !R_FINITE(fixed_log_sum)) {
+            Rcpp::stop("fixed_sum must be positive and finite when n_fixed > 0");
+        }
+
+        // AM-GM: the realized geometric mean cannot exceed the arithmetic mean
+        double arith = fixed_sum / n_fixed;
+        double geom = std::exp(fixed_log_sum / n_fixed);
+        if (geom > arith * (1.0 + 1e-10)) {
+            Rcpp::stop("fixed_log_sum is inconsistent with fixed_sum");
+        }
+    }
+
+    Seasoning seasoning;
+    seasoning.count = n_fixed;
+    seasoning.sum = fixed_sum;
+    seasoning.log_sum = fixed_log_sum;
+    seasoning.min = fixed_min;
+    seasoning.max = fixed_max;
+
+    return seasoning;
+}
+
 double geometric_mean(const std::vector<double>& prices) {
     if (prices.empty()) {
         Rcpp::stop("Cannot compute geometric mean of empty vector");
@@ -74,24 +109,17 @@ std::vector<double> generate_price_path(
     return prices;
 }
 
-double binomial_coefficient(int n, int k) {
-    if (k < 0 || k > n) {
-        return 0.0;
-    }
+std::vector<bool> exercise_schedule(int n, Rcpp::IntegerVector exercise) {
+    std::vector<bool> exercisable(n + 1, exercise.size() == 0);
+    exercisable[0] = false;
 
-    if (k == 0 || k == n) {
-        return 1.0;
-    }
-
-    if (k > n - k) {
-        k = n - k;
-    }
-
-    double result = 1.0;
-    for (int i = 0; i < k; ++i) {
-        result *= (n - i);
-        result /= (i + 1);
+    for (int k = 0; k < (int)exercise.size(); ++k) {
+        if (exercise[k] < 1 || exercise[k] > n) {
+            Rcpp::stop("exercise steps must lie in 1..n");
+        }
+        exercisable[exercise[k]] = true;
     }
+    exercisable[n] = true;
 
-    return result;
+    return exercisable;
 }
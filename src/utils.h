@@ -16,6 +16,25 @@ AdjustedFactors compute_adjusted_factors(
     double lambda, double v_u, double v_d
 );
 
+// Fixings realized before the current spot S0 (seasoned options). The
+// average runs over these plus the n + 1 prices S_0..S_n of the residual tree.
+struct Seasoning {
+    int count;
+    double sum;
+    double log_sum;
+    double min;  // NA_REAL when unknown; only the bounds need the range
+    double max;
+};
+
+Seasoning make_seasoning(
+    int n_fixed, double fixed_sum, double fixed_log_sum,
+    double fixed_min = NA_REAL, double fixed_max = NA_REAL
+);
+
+// Exercise flags for steps 0..n of an early-exercise option: the given
+// steps (each in 1..n) plus maturity, or every step 1..n when none are given
+std::vector<bool> exercise_schedule(int n, Rcpp::IntegerVector exercise);
+
 double geometric_mean(const std::vector<double>& prices);
 
 double arithmetic_mean(const std::vector<double>& prices);
@@ -27,6 +46,4 @@ std::vector<double> generate_price_path(
     double d_tilde
 );
 
-double binomial_coefficient(int n, int k);
-
 #endif